@@ -0,0 +1,96 @@
+// Пакетный расчёт кредитов без графического интерфейса:
+//   SmartCalc2_0_batch loans.csv [Annuitentnie|Differentials] > result.csv
+// Во входном файле первые три колонки - сумма, срок и ставка. Файл читается
+// через ModelData (mmap и параллельный разбор), строки считаются блоками,
+// каждый блок форматируется параллельно и сразу пишется в stdout
+#include <math.h>
+#include <stdio.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../Model/ModelCredit.h"
+#include "../Model/ModelData.h"
+
+#define BATCH_BLOCK (1 << 20)
+#define BATCH_LINE 96
+
+static void write_rows(const double *first, const double *last,
+                       const double *overpayment, const double *total,
+                       size_t begin, size_t end, bool differential,
+                       std::string *out) {
+  out->resize((end - begin) * BATCH_LINE);
+  char *p = &(*out)[0];
+  char *limit = p + out->size();
+  for (size_t k = begin; k < end; k++) {
+    if (isnan(total[k])) {
+      const char error[] = "Incorrect input\n";
+      for (size_t i = 0; i + 1 < sizeof(error); i++) *p++ = error[i];
+    } else {
+      p = s21::ModelCredit::write_fixed(p, limit, first[k]);
+      if (differential) {
+        *p++ = '.';
+        *p++ = '.';
+        p = s21::ModelCredit::write_fixed(p, limit, last[k]);
+      }
+      *p++ = ',';
+      p = s21::ModelCredit::write_fixed(p, limit, overpayment[k]);
+      *p++ = ',';
+      p = s21::ModelCredit::write_fixed(p, limit, total[k]);
+      *p++ = '\n';
+    }
+  }
+  out->resize(p - out->data());
+}
+
+static void price(s21::ModelData &data, std::string type, FILE *output) {
+  s21::ModelCredit model;
+  bool differential = type == "Differentials";
+  size_t rows = data.get_rows();
+  size_t threads = std::thread::hardware_concurrency();
+  if (threads == 0) threads = 1;
+  std::vector<double> first(BATCH_BLOCK), last(BATCH_BLOCK);
+  std::vector<double> overpayment(BATCH_BLOCK), total(BATCH_BLOCK);
+  std::vector<std::string> buffers(threads);
+  fputs("payment,overpayment,total\n", output);
+  for (size_t block = 0; block < rows; block += BATCH_BLOCK) {
+    size_t n = rows - block < BATCH_BLOCK ? rows - block : BATCH_BLOCK;
+    model.calculate_batch(data.get_column(0) + block,
+                          data.get_column(1) + block,
+                          data.get_column(2) + block, n, type, first.data(),
+                          last.data(), overpayment.data(), total.data());
+    std::vector<std::thread> workers;
+    for (size_t k = 0; k < threads; k++)
+      workers.emplace_back(write_rows, first.data(), last.data(),
+                           overpayment.data(), total.data(), n * k / threads,
+                           n * (k + 1) / threads, differential, &buffers[k]);
+    for (size_t k = 0; k < threads; k++) {
+      workers[k].join();
+      fwrite(buffers[k].data(), 1, buffers[k].size(), output);
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  int res = 0;
+  std::string type = argc > 2 ? argv[2] : "Annuitentnie";
+  if (argc < 2 || argc > 3 ||
+      (type != "Annuitentnie" && type != "Differentials")) {
+    fprintf(stderr, "usage: %s loans.csv [Annuitentnie|Differentials]\n",
+            argv[0]);
+    res = 1;
+  } else {
+    s21::ModelData data;
+    std::string error = data.load(argv[1]);
+    if (error.empty() && data.get_columns() < 3)
+      error = "Expected columns: sum, time, precent";
+    if (error.empty()) {
+      price(data, type, stdout);
+    } else {
+      fprintf(stderr, "%s\n", error.c_str());
+      res = 1;
+    }
+  }
+  return res;
+}
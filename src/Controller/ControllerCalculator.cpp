@@ -7,5 +7,15 @@ QString ControllerCalculator::calculate(QString text) {
 QString ControllerCalculator::set_x(QString text, QString previous_x) {
   return model->set_x(text, previous_x);
 }
+QString ControllerCalculator::load_plugin(QString path, QString names) {
+  return model->load_plugin(path, names);
+}
+void ControllerCalculator::set_complex(bool value) {
+  model->set_complex(value);
+}
+void ControllerCalculator::set_digits(int value) { model->set_digits(value); }
+void ControllerCalculator::set_parallel(bool value) {
+  model->set_parallel(value);
+}
 
 }  // namespace s21
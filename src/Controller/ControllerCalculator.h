@@ -10,6 +10,10 @@ class ControllerCalculator {
   ControllerCalculator(s21::ModelCalculator *m) : model(m) {}
   QString calculate(QString text);
   QString set_x(QString text, QString previous_x);
+  QString load_plugin(QString path, QString names);
+  void set_complex(bool value);
+  void set_digits(int value);
+  void set_parallel(bool value);
 
  private:
   ModelCalculator *model;
@@ -17,4 +17,12 @@ std::string ControllerCredit::get_overpayment() {
 
 std::string ControllerCredit::get_sum_total() { return model->get_sum_total(); }
 
+int ControllerCredit::get_schedule_rows() { return model->get_schedule_rows(); }
+
+bool ControllerCredit::get_schedule_row(int month, double *payment,
+                                        double *principal, double *interest,
+                                        double *rest) {
+  return model->get_schedule_row(month, payment, principal, interest, rest);
+}
+
 }  // namespace s21
\ No newline at end of file
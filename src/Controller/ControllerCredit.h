@@ -13,6 +13,9 @@ class ControllerCredit {
   std::string get_payment();
   std::string get_overpayment();
   std::string get_sum_total();
+  int get_schedule_rows();
+  bool get_schedule_row(int month, double *payment, double *principal,
+                        double *interest, double *rest);
 
  private:
   ModelCredit *model;
@@ -10,6 +10,24 @@ QString ControllerGraph::get_axis(QString previous, QString min_x,
 
 void ControllerGraph::calculate(QString text) { model->calculate_graph(text); }
 
+void ControllerGraph::set_precise(bool value) { model->set_precise(value); }
+
+QString ControllerGraph::check_implicit(QString text) {
+  return model->check_implicit(text);
+}
+
+void ControllerGraph::calculate_implicit(QString text) {
+  model->calculate_implicit(text);
+}
+
+QString ControllerGraph::check_complex(QString text) {
+  return model->check_complex(text);
+}
+
+void ControllerGraph::calculate_domain(QString text) {
+  model->calculate_domain(text);
+}
+
 int ControllerGraph::get_min_x() { return model->get_min_x(); }
 
 int ControllerGraph::get_max_x() { return model->get_max_x(); }
@@ -21,4 +39,38 @@ int ControllerGraph::get_max_y() { return model->get_max_y(); }
 QVector<double> ControllerGraph::get_x_cords() { return model->x; }
 
 QVector<double> ControllerGraph::get_y_cords() { return model->y; }
+
+QVector<double> ControllerGraph::get_implicit_x() { return model->implicit_x; }
+
+QVector<double> ControllerGraph::get_implicit_y() { return model->implicit_y; }
+
+QVector<double> ControllerGraph::get_domain() { return model->domain; }
+
+QString ControllerGraph::load_data(QString path) {
+  return QString::fromStdString(model->data.load(path.toStdString()));
+}
+
+size_t ControllerGraph::get_data_rows() { return model->data.get_rows(); }
+
+size_t ControllerGraph::get_data_columns() {
+  return model->data.get_columns();
+}
+
+const double *ControllerGraph::get_data_column(size_t column) {
+  return model->data.get_column(column);
+}
+
+QString ControllerGraph::fit(QString expression, QString parameters) {
+  return model->calculate_fit(expression, parameters);
+}
+
+QVector<double> ControllerGraph::get_fit_x() { return model->fit_x; }
+
+QVector<double> ControllerGraph::get_fit_y() { return model->fit_y; }
+
+void ControllerGraph::calculate_spectrum() { model->calculate_spectrum(); }
+
+QVector<double> ControllerGraph::get_spectrum_x() { return model->spectrum_x; }
+
+QVector<double> ControllerGraph::get_spectrum_y() { return model->spectrum_y; }
 }  // namespace s21
@@ -14,6 +14,11 @@ class ControllerGraph {
   QString get_axis(QString previous, QString min_x, QString max_x,
                    QString min_y, QString max_y);
   void calculate(QString text);
+  void set_precise(bool value);
+  QString check_implicit(QString text);
+  void calculate_implicit(QString text);
+  QString check_complex(QString text);
+  void calculate_domain(QString text);
 
   int get_min_x();
   int get_max_x();
@@ -22,6 +27,22 @@ class ControllerGraph {
 
   QVector<double> get_x_cords();
   QVector<double> get_y_cords();
+  QVector<double> get_implicit_x();
+  QVector<double> get_implicit_y();
+  QVector<double> get_domain();
+
+  QString load_data(QString path);
+  size_t get_data_rows();
+  size_t get_data_columns();
+  const double *get_data_column(size_t column);
+
+  QString fit(QString expression, QString parameters);
+  QVector<double> get_fit_x();
+  QVector<double> get_fit_y();
+
+  void calculate_spectrum();
+  QVector<double> get_spectrum_x();
+  QVector<double> get_spectrum_y();
 
  private:
   ModelGraph *model;
@@ -1,6 +1,11 @@
 #include "MainModel.h"
 
+#include <thread>
+
 namespace s21 {
+// Поток уже работает внутри параллельного вычисления
+static thread_local bool worker = false;
+
 //----------------------------calculate
 int MainModel::calculate(Stack **ready, double *result) {
   int res = 0;
@@ -11,10 +16,11 @@ int MainModel::calculate(Stack **ready, double *result) {
     calculate_2(ready, &number, &flag_error_math);
     calculate_3(ready, &number, &flag_error_math);
     calculate_4(ready, &number, &flag_error_math);
+    calculate_5(ready, &number, &flag_error_math);
   }
   if (number) {
     *result = number->value;
-    pop_node(&number);
+    remove_node(&number);
   } else
     flag_error_math = 1;
   if (!flag_error_math) res = 1;
@@ -31,7 +37,8 @@ void MainModel::calculate_1(Stack **ready, Stack **number,
     push_node(number, (*ready)->value, (*ready)->priority, (*ready)->type);
     pop_node(ready);
   }
-  if (peek_node(*ready) == 2 && !(*flag_error_math)) {
+  if ((peek_node(*ready) == 2 || peek_node(*ready) == 20) &&
+      !(*flag_error_math)) {
     push_node(number, (*ready)->value, (*ready)->priority, (*ready)->type);
     pop_node(ready);
   }
@@ -200,6 +207,29 @@ void MainModel::calculate_4(Stack **ready, Stack **number,
   }
 }
 
+// Сравнения и abs считаются теми же функциями, что и в пакетном режиме
+void MainModel::calculate_5(Stack **ready, Stack **number,
+                            int *flag_error_math) {
+  double tmp_1 = 0;
+  double tmp_2 = 0;
+  int type = peek_node(*ready);
+  if (type >= op_less && type <= op_not_equal && !(*flag_error_math)) {
+    tmp_2 = (*number)->value;
+    pop_node(number);
+    tmp_1 = (*number)->value;
+    pop_node(number);
+    calculate_binary(my_type(type), &tmp_1, &tmp_2, 1);
+    push_node(number, tmp_1, get_priority(Number), Number);
+    pop_node(ready);
+  }
+  if (type == f_abs && !(*flag_error_math)) {
+    tmp_1 = fabs((*number)->value);
+    pop_node(number);
+    push_node(number, tmp_1, get_priority(Number), Number);
+    pop_node(ready);
+  }
+}
+
 int MainModel::final_func(char *input, double *calculated, double x) {
   int result = 0;
   char res[MAX_SIZE_STRING] = "";
@@ -228,6 +258,374 @@ int MainModel::final_func(char *input, double *calculated, double x) {
   return result;
 }
 
+//-------------------------program
+int MainModel::compile_func(char *input, Stack **program) {
+  int result = -2;
+  char res[MAX_SIZE_STRING] = "";
+  if (strlen(input) < MAX_SIZE_STRING) {
+    trim_input(input, res);
+    if (valid_input(res)) {
+      build_program(res, program);
+      result = 1;
+    }
+  }
+  return result;
+}
+
+void MainModel::build_program(char *input, Stack **program) {
+  build_named_program(input, program, {}, var_column);
+}
+
+// Имена из names становятся узлами типа type со значением = номер имени
+void MainModel::build_named_program(char *input, Stack **program,
+                                    const std::vector<std::string> &names,
+                                    my_type type) {
+  Stack *inverse_orig = NULL;
+  Stack *orig = NULL;
+  Stack *inverse_ready = NULL;
+  Stack *support = NULL;
+  named_stack_from_str(&inverse_orig, input, names, type);
+  inverse_stack(&inverse_orig, &orig);
+  notation_stack(&orig, &inverse_ready, &support);
+  inverse_stack(&inverse_ready, program);
+}
+
+// Глубина стека значений, нужная программе; -1 если программа некорректна
+int MainModel::program_depth(Stack *program) {
+  int depth = 0;
+  int max_depth = 0;
+  int flag_er = 0;
+  for (Stack *node = program; node && !flag_er; node = node->next) {
+    if (node->type == Number || is_variable(node->type))
+      depth++;
+    else if (is_binary(node->type))
+      depth--;
+    else if (!is_unary(node->type))
+      flag_er = 1;
+    if (depth < 1) flag_er = 1;
+    if (depth > max_depth) max_depth = depth;
+  }
+  if (flag_er || depth != 1) max_depth = -1;
+  return max_depth;
+}
+
+// Глубина стека упакованной программы или -1, если она некорректна
+int MainModel::code_depth(const Program &program) {
+  int depth = 0;
+  int max_depth = 0;
+  for (size_t i = 0; i < program.code.size(); i++) {
+    my_type type = (my_type)program.code[i];
+    if (type == Number || is_variable(type) || type == var_i ||
+        type == f_sum || type == f_prod)
+      depth++;
+    if (is_binary(type)) depth--;
+    if (type == f_if) depth -= 2;
+    if (type == var_column || type == var_param || type == f_plugin ||
+        type == f_sum || type == f_prod)
+      i++;
+    if (depth > max_depth) max_depth = depth;
+  }
+  return depth == 1 ? max_depth : -1;
+}
+
+// Для вычислений список узлов (32 байта и malloc на токен) переводится в
+// плотный байт-код; некорректная программа получает depth = -1
+void MainModel::pack_program(Stack *program, Program *packed) {
+  packed->code.clear();
+  packed->constants.clear();
+  packed->plugins.clear();
+  packed->loops.clear();
+  packed->depth = program_depth(program);
+  for (Stack *node = program; node && packed->depth > 0; node = node->next) {
+    packed->code.push_back((unsigned char)node->type);
+    if (node->type == Number) packed->constants.push_back(node->value);
+    if (node->type == var_column || node->type == var_param)
+      packed->code.push_back((unsigned char)node->value);
+  }
+}
+
+int MainModel::calculate_program(Stack *program, double x, double y,
+                                 double *result) {
+  int res = -1;
+  Program packed;
+  pack_program(program, &packed);
+  double *buffer = NULL;
+  if (packed.depth > 0)
+    buffer = (double *)malloc(packed.depth * sizeof(double));
+  if (buffer != NULL) {
+    const double *vars[2] = {&x, &y};
+    double tmp = 0;
+    calculate_chunk(packed, vars, 0, 1, buffer, &tmp);
+    if (!isnan(tmp)) {
+      *result = tmp;
+      res = 1;
+    }
+    free(buffer);
+  }
+  return res;
+}
+
+// Значения переменных: vars[0] - массив x, vars[1] - массив y,
+// vars[2 + k] - столбец с номером k или одно значение параметра k.
+// Точки, где выражение не определено, получают NAN.
+void MainModel::calculate_batch(Stack *program, const double *const *vars,
+                                double *result, size_t n) {
+  Program packed;
+  pack_program(program, &packed);
+  double *buffer = NULL;
+  if (packed.depth > 0)
+    buffer = (double *)malloc(packed.depth * BATCH_CHUNK * sizeof(double));
+  if (buffer != NULL) {
+    for (size_t offset = 0; offset < n; offset += BATCH_CHUNK) {
+      size_t len = n - offset < BATCH_CHUNK ? n - offset : BATCH_CHUNK;
+      calculate_chunk(packed, vars, offset, len, buffer, result + offset);
+    }
+    free(buffer);
+  } else {
+    for (size_t j = 0; j < n; j++) result[j] = NAN;
+  }
+}
+
+void MainModel::calculate_chunk(const Program &program,
+                                const double *const *vars, size_t offset,
+                                size_t len, double *buffer, double *result) {
+  int top = 0;
+  const double *constant = program.constants.data();
+  const unsigned char *code = program.code.data();
+  const unsigned char *end = code + program.code.size();
+  while (code < end) {
+    my_type type = (my_type)*code++;
+    if (type == Number) {
+      double *out = buffer + top * len;
+      double value = *constant++;
+      for (size_t j = 0; j < len; j++) out[j] = value;
+      top++;
+    } else if (type == var_param) {
+      double *out = buffer + top * len;
+      double value = vars[2 + *code++][0];
+      for (size_t j = 0; j < len; j++) out[j] = value;
+      top++;
+    } else if (is_variable(type)) {
+      double *out = buffer + top * len;
+      int slot = type == var_x ? 0 : 1;
+      if (type == var_column) slot = 2 + *code++;
+      const double *in = vars[slot] + offset;
+      for (size_t j = 0; j < len; j++) out[j] = in[j];
+      top++;
+    } else if (is_binary(type)) {
+      top--;
+      calculate_binary(type, buffer + (top - 1) * len, buffer + top * len,
+                       len);
+    } else if (type == var_i) {
+      double *out = buffer + top * len;
+      for (size_t j = 0; j < len; j++) out[j] = NAN;
+      top++;
+    } else if (type == f_if) {
+      top -= 2;
+      calculate_select(buffer + (top - 1) * len, buffer + top * len,
+                       buffer + (top + 1) * len, len);
+    } else if (type == f_sum || type == f_prod) {
+      double *out = buffer + top * len;
+      const Loop &loop = program.loops[*code++];
+      for (size_t j = 0; j < len; j++)
+        out[j] = calculate_loop(loop, type, vars, offset + j);
+      top++;
+    } else if (type == f_plugin) {
+      const Plugin &plugin = program.plugins[*code++];
+      double *a = buffer + (top - 1) * len;
+      if (len == 1)
+        a[0] = plugin.scalar(a[0]);
+      else
+        plugin.batch(a, a, len);
+    } else {
+      calculate_unary(type, buffer + (top - 1) * len, len);
+    }
+  }
+  memcpy(result, buffer, len * sizeof(double));
+}
+
+// Диапазон k режется на блоки по LOOP_BLOCK слагаемых, блоки делятся
+// между потоками, а частичные результаты складываются попарно в порядке
+// номеров блоков, поэтому ответ не зависит от числа потоков. Один блок, а
+// также циклы внутри рабочих потоков (графика, пакетов, поддеревьев)
+// считаются в текущем потоке
+double MainModel::calculate_loop(const Loop &loop, my_type type,
+                                 const double *const *vars, size_t index) {
+  size_t slots = 2;
+  for (size_t i = 0; i < loop.body.code.size(); i++) {
+    my_type node = (my_type)loop.body.code[i];
+    if (node == var_param && loop.body.code[i + 1] + 3u > slots)
+      slots = loop.body.code[i + 1] + 3u;
+    if (node == var_column || node == var_param || node == f_plugin) i++;
+  }
+  double x = vars[0] != NULL ? vars[0][index] : 0;
+  long long terms = loop.to >= loop.from ? loop.to - loop.from + 1 : 0;
+  size_t blocks = (terms + LOOP_BLOCK - 1) / LOOP_BLOCK;
+  std::vector<double> value(blocks), error(blocks);
+  size_t threads = worker ? 1 : std::thread::hardware_concurrency();
+  if (threads > blocks) threads = blocks;
+  auto run = [&](size_t t, size_t step) {
+    for (size_t b = t; b < blocks; b += step) {
+      long long begin = loop.from + (long long)b * LOOP_BLOCK;
+      long long end =
+          begin + LOOP_BLOCK - 1 < loop.to ? begin + LOOP_BLOCK - 1 : loop.to;
+      loop_block(loop, type, vars, slots, x, begin, end, &value[b],
+                 &error[b]);
+    }
+  };
+  std::vector<std::thread> workers;
+  if (threads <= 1) run(0, 1);
+  for (size_t t = 0; t < threads && threads > 1; t++)
+    workers.push_back(std::thread([&, t]() {
+      set_worker();
+      run(t, threads);
+    }));
+  for (size_t t = 0; t < workers.size(); t++) workers[t].join();
+  for (size_t step = 1; step < blocks; step *= 2) {
+    for (size_t b = 0; b + step < blocks; b += 2 * step) {
+      double a = value[b];
+      double c = value[b + step];
+      if (type == f_sum) {
+        value[b] = a + c;
+        double z = value[b] - a;
+        error[b] += error[b + step] + (a - (value[b] - z)) + (c - z);
+      } else {
+        value[b] = a * c;
+        error[b] = fma(a, c, -value[b]) + a * error[b + step] +
+                   error[b] * c;
+      }
+    }
+  }
+  double res = type == f_sum ? 0 : 1;
+  if (blocks > 0) res = value[0] + error[0];
+  return res;
+}
+
+// Вызывается в начале рабочего потока, чтобы суммы в нём не создавали
+// своих потоков
+void MainModel::set_worker() { worker = true; }
+
+// Сумма по Ноймайеру или произведение с поправкой через fma: value + error
+// точнее, чем одно накопление в double. Внешние переменные не копируются:
+// свои у блока только ячейки k и x (внешний x тела цикла) на стеке
+void MainModel::loop_block(const Loop &loop, my_type type,
+                           const double *const *vars, size_t slots, double x,
+                           long long begin, long long end, double *value,
+                           double *error) {
+  double k[BATCH_CHUNK];
+  double outer[BATCH_CHUNK];
+  double out[BATCH_CHUNK];
+  const double *inner[LOOP_MAX_SLOTS] = {k, outer};
+  for (size_t j = 2; j < slots; j++) inner[j] = vars[j];
+  std::vector<double> buffer(loop.body.depth * BATCH_CHUNK);
+  double s = type == f_sum ? 0 : 1;
+  double c = 0;
+  for (size_t j = 0; j < BATCH_CHUNK; j++) outer[j] = x;
+  for (long long first = begin; first <= end; first += BATCH_CHUNK) {
+    size_t len = end - first + 1 < BATCH_CHUNK ? end - first + 1 : BATCH_CHUNK;
+    for (size_t j = 0; j < len; j++) k[j] = first + j;
+    calculate_chunk(loop.body, inner, 0, len, buffer.data(), out);
+    for (size_t j = 0; j < len; j++) {
+      double t = type == f_sum ? s + out[j] : s * out[j];
+      if (type == f_prod)
+        c = c * out[j] + fma(s, out[j], -t);
+      else if (fabs(s) >= fabs(out[j]))
+        c += (s - t) + out[j];
+      else
+        c += (out[j] - t) + s;
+      s = t;
+    }
+  }
+  *value = s;
+  *error = c;
+}
+
+void MainModel::calculate_binary(my_type type, double *a, const double *b,
+                                 size_t len) {
+  if (type == op_plus)
+    for (size_t j = 0; j < len; j++) a[j] = a[j] + b[j];
+  if (type == op_minus)
+    for (size_t j = 0; j < len; j++) a[j] = a[j] - b[j];
+  if (type == op_mul)
+    for (size_t j = 0; j < len; j++) a[j] = b[j] * a[j];
+  if (type == op_div)
+    for (size_t j = 0; j < len; j++) a[j] = b[j] != 0 ? a[j] / b[j] : NAN;
+  if (type == op_mod)
+    for (size_t j = 0; j < len; j++)
+      a[j] = b[j] != 0 ? fmod(a[j], b[j]) : NAN;
+  if (type == op_power)
+    for (size_t j = 0; j < len; j++) a[j] = pow(a[j], b[j]);
+  // Сравнения дают 1 или 0 без ветвлений; NAN в операнде даёт NAN
+  if (type == op_less)
+    for (size_t j = 0; j < len; j++)
+      a[j] = isnan(a[j]) || isnan(b[j]) ? NAN : (double)(a[j] < b[j]);
+  if (type == op_greater)
+    for (size_t j = 0; j < len; j++)
+      a[j] = isnan(a[j]) || isnan(b[j]) ? NAN : (double)(a[j] > b[j]);
+  if (type == op_less_eq)
+    for (size_t j = 0; j < len; j++)
+      a[j] = isnan(a[j]) || isnan(b[j]) ? NAN : (double)(a[j] <= b[j]);
+  if (type == op_greater_eq)
+    for (size_t j = 0; j < len; j++)
+      a[j] = isnan(a[j]) || isnan(b[j]) ? NAN : (double)(a[j] >= b[j]);
+  if (type == op_equal)
+    for (size_t j = 0; j < len; j++)
+      a[j] = isnan(a[j]) || isnan(b[j]) ? NAN : (double)(a[j] == b[j]);
+  if (type == op_not_equal)
+    for (size_t j = 0; j < len; j++)
+      a[j] = isnan(a[j]) || isnan(b[j]) ? NAN : (double)(a[j] != b[j]);
+  if (type == f_min)
+    for (size_t j = 0; j < len; j++)
+      a[j] = isnan(b[j]) || b[j] < a[j] ? b[j] : a[j];
+  if (type == f_max)
+    for (size_t j = 0; j < len; j++)
+      a[j] = isnan(b[j]) || b[j] > a[j] ? b[j] : a[j];
+}
+
+void MainModel::calculate_unary(my_type type, double *a, size_t len) {
+  if (type == f_sin)
+    for (size_t j = 0; j < len; j++) a[j] = sin(a[j]);
+  if (type == f_cos)
+    for (size_t j = 0; j < len; j++) a[j] = cos(a[j]);
+  if (type == f_tan)
+    for (size_t j = 0; j < len; j++) a[j] = tan(a[j]);
+  if (type == f_asin)
+    for (size_t j = 0; j < len; j++)
+      a[j] = a[j] >= -1 && a[j] <= 1 ? asin(a[j]) : NAN;
+  if (type == f_acos)
+    for (size_t j = 0; j < len; j++)
+      a[j] = a[j] >= -1 && a[j] <= 1 ? acos(a[j]) : NAN;
+  if (type == f_atan)
+    for (size_t j = 0; j < len; j++)
+      a[j] = fmod(a[j], M_PI / 2) > 1e-8 || fmod(a[j], M_PI / 2) < -1e-8
+                 ? atan(a[j])
+                 : NAN;
+  if (type == f_sqrt)
+    for (size_t j = 0; j < len; j++) a[j] = a[j] >= 0 ? sqrt(a[j]) : NAN;
+  if (type == f_ln)
+    for (size_t j = 0; j < len; j++) a[j] = a[j] > 0 ? log(a[j]) : NAN;
+  if (type == f_log)
+    for (size_t j = 0; j < len; j++) a[j] = a[j] > 0 ? log10(a[j]) : NAN;
+  if (type == f_abs)
+    for (size_t j = 0; j < len; j++) a[j] = fabs(a[j]);
+  // Аргумент вещественного числа - 0 или pi, сопряжение ничего не меняет
+  if (type == f_arg)
+    for (size_t j = 0; j < len; j++)
+      a[j] = isnan(a[j]) ? a[j] : (a[j] < 0 ? M_PI : 0);
+}
+
+// if(c, a, b): обе ветви уже посчитаны, выбирается одна из них, так что
+// NAN в невыбранной ветви не портит результат. Оба значения читаются
+// заранее, тогда цикл без ветвлений и векторизуется
+void MainModel::calculate_select(double *c, const double *a, const double *b,
+                                 size_t len) {
+  for (size_t j = 0; j < len; j++) {
+    double yes = a[j];
+    double no = b[j];
+    c[j] = isnan(c[j]) ? c[j] : (c[j] != 0 ? yes : no);
+  }
+}
+
 //-------------------------notation
 void MainModel::notation_stack(Stack **origin, Stack **result,
                                Stack **support) {
@@ -252,8 +650,8 @@ void MainModel::first_part_notation(Stack **origin, Stack **result,
     pop_node(origin);
     *k += 1;
   }
-  // ---------------ИКС---------------------
-  if (peek_node(*origin) == 2) {
+  // ---------------ИКС И ИГРЕК---------------------
+  if (is_variable(peek_node(*origin))) {
     push_node(result, (*origin)->value, (*origin)->priority, (*origin)->type);
     pop_node(origin);
     *k += 1;
@@ -334,8 +732,21 @@ void MainModel::second_part_notation(Stack **origin, Stack **result,
     pop_node(origin);
     *k += 1;
   }
+  // ---------------СРАВНЕНИЯ---------------------
+  if (peek_node(*origin) >= op_less && peek_node(*origin) <= op_not_equal) {
+    while (peek_node(*support) != 0 &&
+           (*support)->priority >= get_priority(op_less)) {
+      push_node(result, (*support)->value, (*support)->priority,
+                (*support)->type);
+      pop_node(support);
+    }
+    push_node(support, (*origin)->value, (*origin)->priority, (*origin)->type);
+    pop_node(origin);
+    *k += 1;
+  }
   // ---------------ФУНКЦИИ---------------------
-  if (peek_node(*origin) >= 11 && peek_node(*origin) <= 19) {
+  if ((peek_node(*origin) >= 11 && peek_node(*origin) <= 19) ||
+      peek_node(*origin) == f_abs) {
     while (peek_node(*support) != 0 &&
            (*support)->priority >= get_priority(MainModel::my_type(11))) {
       push_node(result, (*support)->value, (*support)->priority,
@@ -359,18 +770,21 @@ void MainModel::stack_from_str(Stack **node, char *input, double x) {
 
 int MainModel::get_priority(my_type type) {
   int res = -2;
-  if (type >= 1 && type <= 2) res = 0;
+  if (type == 1 || is_variable(type)) res = 0;
   if (type >= 3 && type <= 4) res = -1;
   if (type >= 5 && type <= 6) res = 1;
   if (type >= 7 && type <= 9) res = 2;
   if (type == 10) res = 3;
   if (type >= 11 && type <= 19) res = 4;
+  if (type >= op_less && type <= op_not_equal) res = 0;
+  if (type == f_abs) res = 4;
   return res;
 }
 
 int MainModel::get_type_simple(char symbol) {
   int res = 0;
   if (is_x(symbol)) res = 2;
+  if (symbol == 'y') res = 20;
   if (is_bracket(symbol) == 1) res = 3;
   if (is_bracket(symbol) == 2) res = 4;
   if (symbol == '+') res = 5;
@@ -384,6 +798,8 @@ int MainModel::get_type_simple(char symbol) {
 int MainModel::get_type_complex(char *input, size_t *i) {
   int res = 0;
   int func = funcs(input, i, 1);
+  int compare = comparison(input, i, 1);
+  if (compare != 0) res = compare;
   if (is_operator(input, i, 1) == 1) res = 9;
   if (func == 1) res = 11;
   if (func == 2) res = 12;
@@ -394,6 +810,7 @@ int MainModel::get_type_complex(char *input, size_t *i) {
   if (func == 7) res = 17;
   if (func == 8) res = 18;
   if (func == 9) res = 19;
+  if (func == 10) res = f_abs;
   return res;
 }
 
@@ -426,6 +843,75 @@ void MainModel::number_symbols(Stack **node, char *input, size_t *i) {
   }
 }
 
+void MainModel::named_stack_from_str(Stack **node, char *input,
+                                     const std::vector<std::string> &names,
+                                     my_type type) {
+  for (size_t i = 0; input[i] != '\0'; i++) {
+    int index = 0;
+    size_t len = match_name(input, i, names, &index);
+    if (len > 0) {
+      push_node(node, index, get_priority(type), type);
+      i += len - 1;
+    } else {
+      simple_symbols(node, input[i], 0);
+      complex_symbols(node, input, &i);
+      number_symbols(node, input, &i);
+    }
+  }
+}
+
+// Имя: буквы, цифры и '_', не с цифры, не занято функциями и x/y
+int MainModel::valid_name(std::string name) {
+  static const char *reserved[] = {"sin", "cos", "tan", "asin", "acos",
+                                   "atan", "sqrt", "ln", "log", "mod",
+                                   "abs", "if", "min", "max", "sum",
+                                   "prod", "arg", "conj", "i", "x", "y"};
+  int res = !name.empty() && !isdigit(name[0]);
+  for (size_t i = 0; i < name.size() && res; i++)
+    if (!(isalnum(name[i]) || name[i] == '_')) res = 0;
+  for (size_t k = 0; k < sizeof(reserved) / sizeof(*reserved) && res; k++)
+    if (name == reserved[k]) res = 0;
+  return res;
+}
+
+// Самое длинное имя, которое начинается с позиции i не внутри другого
+// слова (перед ним нет буквы, цифры или '_') и не продолжается ими;
+// возвращает его длину или 0
+size_t MainModel::match_name(char *input, size_t i,
+                             const std::vector<std::string> &names,
+                             int *index) {
+  size_t res = 0;
+  bool start = i == 0 || !(isalnum(input[i - 1]) || input[i - 1] == '_');
+  for (size_t k = 0; k < names.size() && start; k++) {
+    size_t len = names[k].size();
+    if (len > res && strncmp(input + i, names[k].c_str(), len) == 0) {
+      char next = input[i + len];
+      if (!(isalnum(next) || next == '_')) {
+        res = len;
+        *index = k;
+      }
+    }
+  }
+  return res;
+}
+
+// Для проверки ввода каждое имя заменяется на x
+void MainModel::mask_names(char *input, char *result,
+                           const std::vector<std::string> &names) {
+  size_t j = 0;
+  for (size_t i = 0; input[i] != '\0'; i++) {
+    int index = 0;
+    size_t len = match_name(input, i, names, &index);
+    if (len > 0) {
+      result[j++] = 'x';
+      i += len - 1;
+    } else {
+      result[j++] = input[i];
+    }
+  }
+  result[j] = '\0';
+}
+
 void MainModel::inverse_stack(Stack **input, Stack **result) {
   while (*input) {
     push_node(result, (*input)->value, (*input)->priority, (*input)->type);
@@ -566,11 +1052,26 @@ int MainModel::is_operator(char *input, size_t *i, int offset) {
     exist_operator = 1;
     *i += 1 - offset;
   }
+  if (!exist_mod && !exist_operator && comparison(input, i, offset) != 0)
+    exist_operator = 1;
   if (exist_mod) res = 1;
   if (exist_operator) res = 2;
   return res;
 }
 
+// <, >, <=, >=, ==, != ; возвращает тип операции или 0
+int MainModel::comparison(char *input, size_t *i, int offset) {
+  int res = 0;
+  char next = input[*i] != '\0' ? input[*i + 1] : '\0';
+  if (input[*i] == '<') res = next == '=' ? op_less_eq : op_less;
+  if (input[*i] == '>') res = next == '=' ? op_greater_eq : op_greater;
+  if (input[*i] == '=' && next == '=') res = op_equal;
+  if (input[*i] == '!' && next == '=') res = op_not_equal;
+  if (res == op_less || res == op_greater) *i += 1 - offset;
+  if (res != 0 && res != op_less && res != op_greater) *i += 2 - offset;
+  return res;
+}
+
 int MainModel::valid_after_operator(char *input) {
   int res = 0;
   int flag_er = 0;
@@ -663,6 +1164,8 @@ int MainModel::valid_start(char *input) {
   int flag_er = 0;
   size_t i = 0;
   if (input[i] == '^' || input[i] == '*' || input[i] == '/') flag_er = 1;
+  if (input[i] == '<' || input[i] == '>' || input[i] == '=' || input[i] == '!')
+    flag_er = 1;
   if (is_operator(input, &i, 0) == 1) flag_er = 1;
   if (!flag_er) res = 1;
   return res;
@@ -673,6 +1176,22 @@ int MainModel::is_number(char symbol) {
   return (symbol >= '0' && symbol <= '9');
 }
 
+int MainModel::is_variable(int type) {
+  return type == var_x || type == var_y || type == var_column ||
+         type == var_param;
+}
+
+int MainModel::is_binary(int type) {
+  return (type >= op_plus && type <= op_power) ||
+         (type >= op_less && type <= op_not_equal) || type == f_min ||
+         type == f_max;
+}
+
+int MainModel::is_unary(int type) {
+  return (type >= f_sin && type <= f_log) || type == f_abs ||
+         type == f_arg || type == f_conj;
+}
+
 int MainModel::valid_number(char *input) {
   int res = 0;
   int len = strlen(input);
@@ -728,6 +1247,10 @@ int MainModel::trigonometry(char *input, size_t *i, int offset) {
 int MainModel::funcs(char *input, size_t *i, int offset) {
   int res = 0;
   int tmp = 0;
+  if (strncmp(input + *i, "abs", 3) == 0) {
+    res = 10;
+    *i += 3 - offset;
+  }
   if (input[*i] == 'l') {
     if (strlen(input) - *i - 1 >= 1) {
       if (input[*i + 1] == 'n') {
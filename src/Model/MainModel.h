@@ -2,11 +2,20 @@
 #ifndef CPP3_SMARTCALC_SRC_MODEL_MAINMODEL_H
 #define CPP3_SMARTCALC_SRC_MODEL_MAINMODEL_H
 
+#include <ctype.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+
+#include <string>
+#include <vector>
 #define MAX_SIZE_STRING 256
+#define BATCH_CHUNK 256
+#define LOOP_BLOCK (1 << 14)
+#define LOOP_MAX_TERMS 1000000000LL
+// k, x и параметры: номер параметра в коде занимает один байт
+#define LOOP_MAX_SLOTS (256 + 3)
 
 namespace s21 {
 class MainModel {
@@ -30,7 +39,26 @@ class MainModel {
     f_atan = 16,
     f_sqrt = 17,
     f_ln = 18,
-    f_log = 19
+    f_log = 19,
+    var_y = 20,
+    var_column = 21,
+    var_param = 22,
+    f_plugin = 23,
+    f_sum = 24,
+    f_prod = 25,
+    op_less = 26,
+    op_greater = 27,
+    op_less_eq = 28,
+    op_greater_eq = 29,
+    op_equal = 30,
+    op_not_equal = 31,
+    f_abs = 32,
+    f_min = 33,
+    f_max = 34,
+    f_if = 35,
+    f_arg = 36,
+    f_conj = 37,
+    var_i = 38
   } my_type;
 
   typedef struct Stack {
@@ -40,6 +68,36 @@ class MainModel {
     struct Stack *next;
   } Stack;
 
+  // Функция из внешней библиотеки: скалярная и пакетная версии, in и out
+  // пакетной могут совпадать
+  typedef struct Plugin {
+    double (*scalar)(double);
+    void (*batch)(const double *in, double *out, size_t n);
+  } Plugin;
+
+  struct Loop;
+
+  // Упакованная программа: один байт на операцию (тип узла), у var_column,
+  // var_param, f_plugin, f_sum и f_prod за ним байт с номером; числа лежат
+  // по порядку в constants, функции f_plugin - в plugins, суммы и
+  // произведения - в loops. var_i - мнимая единица, вещественное
+  // вычисление даёт на ней NAN
+  typedef struct Program {
+    std::vector<unsigned char> code;
+    std::vector<double> constants;
+    std::vector<Plugin> plugins;
+    std::vector<Loop> loops;
+    int depth;
+  } Program;
+
+  // Сумма или произведение тела по целым k от from до to. В теле k - это
+  // var_x, а x внешнего выражения - var_y; параметры общие с внешним
+  struct Loop {
+    Program body;
+    long long from;
+    long long to;
+  };
+
   int valid_input(char *input);
   void trim_input(char *input, char *result);
   int valid_x(char *input);
@@ -49,6 +107,7 @@ class MainModel {
   int bracket_after_func(char *input);
 
   int is_operator(char *input, size_t *i, int offset);
+  int comparison(char *input, size_t *i, int offset);
   int valid_after_operator(char *input);
   int valid_after_mod(char *input);
   int valid_mul(char *input);
@@ -62,6 +121,9 @@ class MainModel {
   int is_dot(char *input, int i);
   int is_x(char symbol);
   int is_number(char symbol);
+  int is_variable(int type);
+  int is_binary(int type);
+  int is_unary(int type);
   int valid_number(char *input);
 
   void push_node(Stack **head, double value, int priority, my_type type);
@@ -79,6 +141,15 @@ class MainModel {
   void number_symbols(Stack **node, char *input, size_t *i);
   void inverse_stack(Stack **input, Stack **result);
 
+  int valid_name(std::string name);
+  size_t match_name(char *input, size_t i,
+                    const std::vector<std::string> &names, int *index);
+  void mask_names(char *input, char *result,
+                  const std::vector<std::string> &names);
+  void named_stack_from_str(Stack **node, char *input,
+                            const std::vector<std::string> &names,
+                            my_type type);
+
   void first_part_notation(Stack **origin, Stack **result, Stack **support,
                            int *k);
   void second_part_notation(Stack **origin, Stack **result, Stack **support,
@@ -90,7 +161,33 @@ class MainModel {
   void calculate_2(Stack **ready, Stack **number, int *flag_error_math);
   void calculate_3(Stack **ready, Stack **number, int *flag_error_math);
   void calculate_4(Stack **ready, Stack **number, int *flag_error_math);
+  void calculate_5(Stack **ready, Stack **number, int *flag_error_math);
   int final_func(char *input, double *calculated, double x);
+
+  int compile_func(char *input, Stack **program);
+  void build_program(char *input, Stack **program);
+  void build_named_program(char *input, Stack **program,
+                           const std::vector<std::string> &names,
+                           my_type type);
+  int program_depth(Stack *program);
+  void pack_program(Stack *program, Program *packed);
+  int code_depth(const Program &program);
+  int calculate_program(Stack *program, double x, double y, double *result);
+  void calculate_batch(Stack *program, const double *const *vars,
+                       double *result, size_t n);
+  void calculate_chunk(const Program &program, const double *const *vars,
+                       size_t offset, size_t len, double *buffer,
+                       double *result);
+  double calculate_loop(const Loop &loop, my_type type,
+                        const double *const *vars, size_t index);
+  static void set_worker();
+  void loop_block(const Loop &loop, my_type type, const double *const *vars,
+                  size_t slots, double x, long long begin, long long end,
+                  double *value, double *error);
+  void calculate_binary(my_type type, double *a, const double *b, size_t len);
+  void calculate_unary(my_type type, double *a, size_t len);
+  void calculate_select(double *c, const double *a, const double *b,
+                        size_t len);
 };
 
 }  // namespace s21
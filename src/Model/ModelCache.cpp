@@ -0,0 +1,218 @@
+#include "ModelCache.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+namespace s21 {
+
+ModelCache::~ModelCache() { close(); }
+
+// Отсутствующий файл - пустой кэш; повреждённый или другой версии
+// отбрасывается и будет перезаписан при save
+std::string ModelCache::open(std::string path) {
+  std::string res_out = "";
+  close();
+  this->path = path;
+  struct stat info;
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd >= 0 && fstat(fd, &info) == 0 && info.st_size > 0) {
+    size_t size = info.st_size;
+    void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data != MAP_FAILED) {
+      map = (const char *)data;
+      map_size = size;
+      Header header;
+      bool valid = size >= sizeof(Header);
+      if (valid) {
+        memcpy(&header, map, sizeof(Header));
+        valid = header.magic == CACHE_MAGIC &&
+                header.version == CACHE_VERSION &&
+                header.count <= (size - sizeof(Header)) / sizeof(Entry) &&
+                header.checksum == hash(map + sizeof(Header),
+                                        size - sizeof(Header));
+      }
+      for (size_t k = 0; valid && k < header.count; k++) {
+        Entry entry;
+        memcpy(&entry, map + sizeof(Header) + k * sizeof(Entry),
+               sizeof(Entry));
+        uint64_t end = entry.offset + entry.text + entry.code;
+        valid = (end + 7) / 8 * 8 + entry.constants * sizeof(double) <= size;
+      }
+      if (valid) {
+        count = header.count;
+      } else {
+        close();
+        this->path = path;
+        res_out = "Incorrect cache";
+      }
+    }
+  }
+  if (fd >= 0) ::close(fd);
+  return res_out;
+}
+
+// Ключ - выражение без пробелов, как его видит compile_func
+int ModelCache::compile(std::string expression, Program *program) {
+  int result = -2;
+  char text[MAX_SIZE_STRING] = "";
+  if (expression.size() < MAX_SIZE_STRING) {
+    char input[MAX_SIZE_STRING] = "";
+    strcpy(input, expression.c_str());
+    trim_input(input, text);
+    if (find(text, program)) {
+      hits++;
+      result = 1;
+    } else {
+      Stack *list = NULL;
+      result = compile_func(text, &list);
+      if (result == 1) {
+        pack_program(list, program);
+        pending[text] = *program;
+        misses++;
+      }
+      remove_node(&list);
+    }
+  }
+  return result;
+}
+
+// Старые и новые записи пишутся во временный файл с уникальным именем в
+// том же каталоге (mkstemp), который затем атомарно заменяет кэш, поэтому
+// одновременные save не портят файлы друг друга
+std::string ModelCache::save() {
+  std::string res_out = "";
+  std::vector<std::pair<std::string, Program>> all;
+  for (size_t k = 0; k < count; k++) {
+    Entry entry;
+    memcpy(&entry, map + sizeof(Header) + k * sizeof(Entry), sizeof(Entry));
+    Program program;
+    read_entry(entry, &program);
+    all.push_back({std::string(map + entry.offset, entry.text), program});
+  }
+  for (auto &item : pending) all.push_back(item);
+  std::sort(all.begin(), all.end(),
+            [](const std::pair<std::string, Program> &a,
+               const std::pair<std::string, Program> &b) {
+              return hash(a.first.data(), a.first.size()) <
+                     hash(b.first.data(), b.first.size());
+            });
+  std::vector<char> body(all.size() * sizeof(Entry));
+  for (size_t k = 0; k < all.size(); k++) {
+    const std::string &text = all[k].first;
+    const Program &program = all[k].second;
+    Entry entry = {hash(text.data(), text.size()),
+                   sizeof(Header) + body.size(),
+                   (uint32_t)text.size(),
+                   (uint32_t)program.code.size(),
+                   (uint32_t)program.constants.size(),
+                   program.depth};
+    memcpy(&body[k * sizeof(Entry)], &entry, sizeof(Entry));
+    body.insert(body.end(), text.begin(), text.end());
+    body.insert(body.end(), program.code.begin(), program.code.end());
+    body.resize((body.size() + 7) / 8 * 8);
+    const char *constants = (const char *)program.constants.data();
+    body.insert(body.end(), constants,
+                constants + program.constants.size() * sizeof(double));
+  }
+  Header header = {CACHE_MAGIC, CACHE_VERSION, all.size(),
+                   hash(body.data(), body.size())};
+  std::string tmp = path + ".XXXXXX";
+  int fd = mkstemp(&tmp[0]);
+  FILE *file = fd < 0 ? NULL : fdopen(fd, "wb");
+  if (file == NULL) {
+    if (fd >= 0) ::close(fd);
+    res_out = "Cannot write cache";
+  } else {
+    bool written = fchmod(fd, 0644) == 0 &&
+                   fwrite(&header, sizeof(Header), 1, file) == 1 &&
+                   fwrite(body.data(), 1, body.size(), file) == body.size();
+    if (fclose(file) != 0 || !written || rename(tmp.c_str(), path.c_str()))
+      res_out = "Cannot write cache";
+  }
+  if (fd >= 0 && !res_out.empty()) unlink(tmp.c_str());
+  if (res_out.empty()) {
+    pending.clear();
+    open(path);
+  }
+  return res_out;
+}
+
+size_t ModelCache::get_entries() { return count + pending.size(); }
+
+size_t ModelCache::get_hits() { return hits; }
+
+size_t ModelCache::get_misses() { return misses; }
+
+void ModelCache::close() {
+  if (map) munmap((void *)map, map_size);
+  map = NULL;
+  map_size = 0;
+  count = 0;
+}
+
+// Двоичный поиск по хэшу, затем сравнение текста среди записей с тем же
+// хэшем
+bool ModelCache::find(const std::string &text, Program *program) {
+  bool res = false;
+  uint64_t key = hash(text.data(), text.size());
+  size_t low = 0, high = count;
+  while (low < high) {
+    size_t middle = (low + high) / 2;
+    uint64_t middle_hash = 0;
+    memcpy(&middle_hash, map + sizeof(Header) + middle * sizeof(Entry),
+           sizeof(uint64_t));
+    if (middle_hash < key)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+  for (size_t k = low; k < count && !res; k++) {
+    Entry entry;
+    memcpy(&entry, map + sizeof(Header) + k * sizeof(Entry), sizeof(Entry));
+    if (entry.hash != key) break;
+    if (entry.text == text.size() &&
+        memcmp(map + entry.offset, text.data(), entry.text) == 0) {
+      read_entry(entry, program);
+      res = true;
+    }
+  }
+  if (!res) {
+    std::map<std::string, Program>::iterator item = pending.find(text);
+    if (item != pending.end()) {
+      *program = item->second;
+      res = true;
+    }
+  }
+  return res;
+}
+
+void ModelCache::read_entry(const Entry &entry, Program *program) {
+  const char *code = map + entry.offset + entry.text;
+  size_t constants = entry.offset + entry.text + entry.code;
+  constants = (constants + 7) / 8 * 8;
+  program->code.assign(code, code + entry.code);
+  program->plugins.clear();
+  program->loops.clear();
+  program->constants.resize(entry.constants);
+  memcpy(program->constants.data(), map + constants,
+         entry.constants * sizeof(double));
+  program->depth = entry.depth;
+}
+
+// FNV-1a, 64 бита
+uint64_t ModelCache::hash(const char *data, size_t size) {
+  uint64_t res = 14695981039346656037ull;
+  for (size_t k = 0; k < size; k++) {
+    res ^= (unsigned char)data[k];
+    res *= 1099511628211ull;
+  }
+  return res;
+}
+
+}  // namespace s21
@@ -0,0 +1,69 @@
+#ifndef CPP3_SMARTCALC_SRC_MODEL_MODELCACHE_H
+#define CPP3_SMARTCALC_SRC_MODEL_MODELCACHE_H
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "MainModel.h"
+
+// Версия меняется вместе с форматом файла и с номерами my_type, которые
+// записаны в байт-код как есть
+#define CACHE_VERSION 1
+#define CACHE_MAGIC 0x43504353u
+
+namespace s21 {
+// Кэш скомпилированных выражений в файле: новый процесс отображает файл в
+// память и получает Program без valid_input, stack_from_str и
+// notation_stack. Формат: заголовок, таблица записей по возрастанию хэша,
+// затем тексты, байт-код и константы; контрольная сумма - по всему, что
+// после заголовка. Объект владеет отображением файла и не копируется
+class ModelCache : public MainModel {
+ public:
+  ModelCache() = default;
+  ModelCache(const ModelCache &) = delete;
+  ModelCache &operator=(const ModelCache &) = delete;
+  ~ModelCache();
+
+  std::string open(std::string path);
+  int compile(std::string expression, Program *program);
+  std::string save();
+
+  size_t get_entries();
+  size_t get_hits();
+  size_t get_misses();
+
+ private:
+  typedef struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t count;
+    uint64_t checksum;
+  } Header;
+
+  typedef struct Entry {
+    uint64_t hash;
+    uint64_t offset;
+    uint32_t text;
+    uint32_t code;
+    uint32_t constants;
+    int32_t depth;
+  } Entry;
+
+  std::string path = "";
+  const char *map = NULL;
+  size_t map_size = 0;
+  size_t count = 0;
+  std::map<std::string, Program> pending;
+  size_t hits = 0;
+  size_t misses = 0;
+
+  void close();
+  bool find(const std::string &text, Program *program);
+  void read_entry(const Entry &entry, Program *program);
+  static uint64_t hash(const char *data, size_t size);
+};
+}  // namespace s21
+
+#endif  // CPP3_SMARTCALC_SRC_MODEL_MODELCACHE_H
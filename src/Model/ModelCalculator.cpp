@@ -13,13 +13,36 @@ QString ModelCalculator::calculate_value(QString text) {
     flag_large = 1;
   }
 
-  if (!flag_empty && !flag_large) {
+  if (!flag_empty && !flag_large &&
+      functions->is_definition(text.toStdString())) {
+    std::string error = functions->define(text.toStdString());
+    result_out = error.empty() ? "Function defined" : error.c_str();
+  } else if (!flag_empty && !flag_large) {
     char *input = text.toUtf8().data();
     double result = 0;
-    int flag = final_func(input, &result, this->x);
+    double result_im = 0;
+    std::string precise = "";
+    int flag = 0;
+    if (functions->get_complex())
+      flag = functions->calculate_complex(text.toStdString(), this->x, 0,
+                                         &result, &result_im);
+    else if (digits > 0)
+      flag = functions->calculate_precise(text.toStdString(), this->x, digits,
+                                         &precise);
+    else if (functions->is_call(text.toStdString()))
+      flag = functions->calculate(text.toStdString(), this->x, &result);
+    else
+      flag = final_func(input, &result, this->x);
     if (flag == 1) {
       result_out = QString::number(result, 'f', 8);
     }
+    if (flag == 1 && !precise.empty()) {
+      result_out = precise.c_str();
+    }
+    if (flag == 1 && result_im != 0) {
+      result_out += result_im < 0 ? " - " : " + ";
+      result_out += QString::number(fabs(result_im), 'f', 8) + "i";
+    }
     if (flag == -1) {
       result_out = "Error in calculation";
     }
@@ -58,4 +81,18 @@ QString ModelCalculator::set_x(QString x_text, QString previous_x) {
   return result_out;
 }
 
+QString ModelCalculator::load_plugin(QString path, QString names) {
+  std::string error = functions->load(path.toStdString(), names.toStdString());
+  return error.empty() ? "Functions loaded" : error.c_str();
+}
+
+void ModelCalculator::set_complex(bool value) { functions->set_complex(value); }
+
+// 0 - обычное вычисление в double
+void ModelCalculator::set_digits(int value) { digits = value; }
+
+void ModelCalculator::set_parallel(bool value) {
+  functions->set_parallel(value);
+}
+
 }  // namespace s21
@@ -6,16 +6,27 @@
 #include <QString>
 
 #include "MainModel.h"
+#include "ModelPrecise.h"
 
 namespace s21 {
 
+// functions - общий с графиком объект пользовательских и библиотечных
+// функций, он должен жить дольше модели
 class ModelCalculator : public MainModel {
  public:
+  explicit ModelCalculator(ModelPrecise *shared) : functions(shared) {}
+
   QString calculate_value(QString text);
   QString set_x(QString x_text, QString previous_x);
+  QString load_plugin(QString path, QString names);
+  void set_complex(bool value);
+  void set_digits(int value);
+  void set_parallel(bool value);
 
  private:
   double x = 0;
+  int digits = 0;
+  ModelPrecise *functions;
 };
 }  // namespace s21
 #endif  // CPP3_SMARTCALC_SRC_MODEL_MODELCALCULATOR_H
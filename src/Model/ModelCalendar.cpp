@@ -0,0 +1,153 @@
+#include "ModelCalendar.h"
+
+namespace s21 {
+
+static const int kMonthStart[2][13] = {
+    {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334, 365},
+    {0, 31, 60, 91, 121, 152, 182, 213, 244, 274, 305, 335, 366}};
+
+// 1 января 1970 года - четверг; суббота и воскресенье сразу помечаются
+// нерабочими
+ModelCalendar::ModelCalendar() {
+  year_start[0] = 0;
+  for (int k = 0; k < CALENDAR_YEARS; k++)
+    year_start[k + 1] =
+        year_start[k] + (is_leap(CALENDAR_FIRST_YEAR + k) ? 366 : 365);
+  closed.assign(year_start[CALENDAR_YEARS] / 64 + 1, 0);
+  for (int number = 0; number < year_start[CALENDAR_YEARS]; number++)
+    if ((number + 3) % 7 >= 5) add_holiday(number);
+}
+
+int ModelCalendar::to_day(int year, int month, int day) const {
+  int res = -1;
+  if (year >= CALENDAR_FIRST_YEAR &&
+      year < CALENDAR_FIRST_YEAR + CALENDAR_YEARS && month >= 1 &&
+      month <= 12)
+    res = year_start[year - CALENDAR_FIRST_YEAR] +
+          kMonthStart[is_leap(year)][month - 1] + day - 1;
+  return res;
+}
+
+// Год ищется по оценке 365.2425 дня в году с поправкой на один шаг
+bool ModelCalendar::from_day(int number, int *year, int *month,
+                             int *day) const {
+  bool res = number >= first_day() && number <= last_day();
+  *year = 0;
+  *month = 0;
+  *day = 0;
+  if (res) {
+    int k = (int)(number / 365.2425);
+    if (k >= CALENDAR_YEARS) k = CALENDAR_YEARS - 1;
+    if (year_start[k] > number) k--;
+    if (year_start[k + 1] <= number) k++;
+    *year = CALENDAR_FIRST_YEAR + k;
+    int rest = number - year_start[k];
+    const int *start = kMonthStart[is_leap(*year)];
+    *month = rest / 31 + 1;
+    if (start[*month] <= rest) (*month)++;
+    *day = rest - start[*month - 1] + 1;
+  }
+  return res;
+}
+
+// Тот же день через months месяцев; 31 января + 1 месяц - конец февраля
+int ModelCalendar::add_months(int number, int months) const {
+  int year = 0, month = 0, day = 0;
+  int res = -1;
+  if (from_day(number, &year, &month, &day)) {
+    long long index = year * 12LL + month - 1 + months;
+    if (index >= CALENDAR_FIRST_YEAR * 12LL &&
+        index < (CALENDAR_FIRST_YEAR + CALENDAR_YEARS) * 12LL) {
+      year = index / 12;
+      month = index % 12 + 1;
+      int length = month_length(year, month);
+      res = to_day(year, month, day < length ? day : length);
+    }
+  }
+  return res;
+}
+
+void ModelCalendar::add_holiday(int number) {
+  if (number >= 0 && number < year_start[CALENDAR_YEARS])
+    closed[number / 64] |= (uint64_t)1 << (number % 64);
+}
+
+bool ModelCalendar::is_business(int number) const {
+  return number >= first_day() && number <= last_day() &&
+         !((closed[number / 64] >> (number % 64)) & 1);
+}
+
+// Modified following: ближайший рабочий день вперёд, а если он уже в
+// следующем месяце - ближайший рабочий день назад. Дата вне таблицы не
+// переносится
+int ModelCalendar::adjust(int number) const {
+  int res = number;
+  int year = 0, month = 0, day = 0, next_month = 0;
+  if (from_day(number, &year, &month, &day)) {
+    res = next_business(number);
+    from_day(res, &year, &next_month, &day);
+    if (next_month != month) res = previous_business(number);
+  }
+  return res;
+}
+
+double ModelCalendar::year_fraction(int begin, int end,
+                                    convention type) const {
+  double res = (end - begin) / 365.0;
+  if (type == act_360) res = (end - begin) / 360.0;
+  if (type == thirty_360) {
+    int y1 = 0, m1 = 0, d1 = 0, y2 = 0, m2 = 0, d2 = 0;
+    from_day(begin, &y1, &m1, &d1);
+    from_day(end, &y2, &m2, &d2);
+    if (d1 == 31) d1 = 30;
+    if (d2 == 31 && d1 == 30) d2 = 30;
+    res = (360 * (y2 - y1) + 30 * (m2 - m1) + d2 - d1) / 360.0;
+  }
+  return res;
+}
+
+int ModelCalendar::first_day() const { return 0; }
+
+int ModelCalendar::last_day() const { return year_start[CALENDAR_YEARS] - 1; }
+
+bool ModelCalendar::is_leap(int year) {
+  return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+int ModelCalendar::month_length(int year, int month) {
+  const int *start = kMonthStart[is_leap(year)];
+  return start[month] - start[month - 1];
+}
+
+// Поиск по словам битовой маски: первый нулевой бит даёт рабочий день
+int ModelCalendar::next_business(int number) const {
+  size_t word = number / 64;
+  uint64_t open = ~closed[word] >> (number % 64);
+  int res = number;
+  if (open) {
+    res += __builtin_ctzll(open);
+  } else {
+    res = (word + 1) * 64;
+    while (word + 1 < closed.size() && !~closed[++word]) res += 64;
+    if (word < closed.size() && ~closed[word])
+      res += __builtin_ctzll(~closed[word]);
+  }
+  return res;
+}
+
+int ModelCalendar::previous_business(int number) const {
+  size_t word = number / 64;
+  int shift = 63 - number % 64;
+  uint64_t open = ~closed[word] << shift;
+  int res = number;
+  if (open) {
+    res -= __builtin_clzll(open);
+  } else {
+    res = word * 64 - 1;
+    while (word > 0 && !~closed[--word]) res -= 64;
+    if (~closed[word]) res -= __builtin_clzll(~closed[word]);
+  }
+  return res;
+}
+
+}  // namespace s21
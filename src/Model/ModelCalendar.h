@@ -0,0 +1,49 @@
+#ifndef CPP3_SMARTCALC_SRC_MODEL_MODELCALENDAR_H
+#define CPP3_SMARTCALC_SRC_MODEL_MODELCALENDAR_H
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#define CALENDAR_FIRST_YEAR 1970
+#define CALENDAR_YEARS 256
+
+namespace s21 {
+// Даты - номера дней от 1 января 1970 года. Границы лет и нерабочие дни
+// (выходные и праздники, по биту на день) считаются заранее, поэтому
+// расчёт дат графика не выделяет память. Даты вне CALENDAR_YEARS лет
+// таблицы не считаются: to_day и add_months возвращают -1, from_day - false
+class ModelCalendar {
+ public:
+  typedef enum convention_t {
+    act_365 = 0,
+    act_360 = 1,
+    thirty_360 = 2
+  } convention;
+
+  ModelCalendar();
+
+  int to_day(int year, int month, int day) const;
+  bool from_day(int number, int *year, int *month, int *day) const;
+  int add_months(int number, int months) const;
+
+  void add_holiday(int number);
+  bool is_business(int number) const;
+  int adjust(int number) const;
+  double year_fraction(int begin, int end, convention type) const;
+
+  int first_day() const;
+  int last_day() const;
+
+ private:
+  int year_start[CALENDAR_YEARS + 1];
+  std::vector<uint64_t> closed;
+
+  static bool is_leap(int year);
+  static int month_length(int year, int month);
+  int next_business(int number) const;
+  int previous_business(int number) const;
+};
+}  // namespace s21
+
+#endif  // CPP3_SMARTCALC_SRC_MODEL_MODELCALENDAR_H
@@ -0,0 +1,211 @@
+#include "ModelChebyshev.h"
+
+#include <algorithm>
+
+namespace s21 {
+
+// Результат: 1, -1 если кусков больше CHEBYSHEV_MAX_PIECES, -2 если
+// выражение зависит не только от x
+int ModelChebyshev::build(const Program &program, double min, double max,
+                          double tolerance) {
+  int res = -2;
+  built = false;
+  pieces.clear();
+  bounds.clear();
+  coefficients.clear();
+  bool free = min < max;
+  for (size_t i = 0; i < program.code.size() && free; i++) {
+    my_type type = (my_type)program.code[i];
+    free = type != var_y && type != var_column && type != var_param &&
+           type != var_i;
+    if (type == f_plugin || type == f_sum || type == f_prod) i++;
+  }
+  if (free) {
+    this->program = program;
+    buffer.resize(program.depth * BATCH_CHUNK);
+    res = fit(min, max, tolerance, 0);
+    built = res == 1;
+    for (size_t p = 0; p < pieces.size() && built; p++)
+      bounds.push_back(pieces[p].from);
+  }
+  return res;
+}
+
+// Построенное приближение подходит, если выражение то же и отрезок внутри
+// исходного, например при увеличении масштаба графика
+bool ModelChebyshev::covers(const Program &program, double min, double max) {
+  return built && same_program(program, this->program) &&
+         min >= pieces.front().from && max <= pieces.back().to;
+}
+
+// Подряд идущие точки одного куска считаются вместе пакетами до
+// BATCH_CHUNK; точки вне отрезка и в прямых кусках - байт-кодом. Без
+// построенного приближения результат - NAN
+void ModelChebyshev::evaluate(const double *x, size_t n, double *result) {
+  if (!built)
+    for (size_t i = 0; i < n; i++) result[i] = NAN;
+  for (size_t i = 0; i < n && built;) {
+    size_t p = locate(x[i]);
+    size_t len = 1;
+    bool inner = p < pieces.size();
+    double from = inner ? pieces[p].from : 0;
+    double to = inner ? pieces[p].to : 0;
+    while (i + len < n && len < BATCH_CHUNK &&
+           ((x[i + len] >= from && x[i + len] < to) ||
+            locate(x[i + len]) == p))
+      len++;
+    if (p < pieces.size() && !pieces[p].direct) {
+      clenshaw(pieces[p], x + i, len, result + i);
+    } else {
+      const double *vars[2] = {x + i, NULL};
+      calculate_chunk(program, vars, 0, len, buffer.data(), result + i);
+    }
+    i += len;
+  }
+}
+
+// Грубая цена вычисления: число вызовов функций и степеней, сумма или
+// произведение сразу считаются дорогими
+int ModelChebyshev::cost(const Program &program) {
+  int res = 0;
+  for (size_t i = 0; i < program.code.size(); i++) {
+    my_type type = (my_type)program.code[i];
+    if ((is_unary(type) && type != f_abs && type != f_arg &&
+         type != f_conj) ||
+        type == op_power || type == f_plugin)
+      res++;
+    if (type == f_sum || type == f_prod) res += CHEBYSHEV_MIN_COST;
+    if (type == var_column || type == var_param || type == f_plugin ||
+        type == f_sum || type == f_prod)
+      i++;
+  }
+  return res;
+}
+
+size_t ModelChebyshev::get_pieces() { return pieces.size(); }
+
+size_t ModelChebyshev::get_direct() {
+  size_t res = 0;
+  for (size_t p = 0; p < pieces.size(); p++) res += pieces[p].direct;
+  return res;
+}
+
+// Значения в узлах cos(pi * i / n) дают коэффициенты дискретным
+// косинус-преобразованием; ряд обрезается, пока отброшенный хвост не
+// больше четверти допуска. Сошедшимся считается ряд, у которого
+// отброшено хотя бы три последних коэффициента, и он проверяется в
+// серединах между узлами. Иначе кусок делится пополам, а на глубине
+// CHEBYSHEV_MAX_DEPTH или там, где функция нигде не определена,
+// остаётся прямым
+int ModelChebyshev::fit(double from, double to, double tolerance,
+                        int depth) {
+  const size_t n = CHEBYSHEV_DEGREE;
+  double mid = (from + to) / 2;
+  double half = (to - from) / 2;
+  double cosine[2 * n];
+  double x[2 * n + 1];
+  double f[2 * n + 1];
+  for (size_t j = 0; j < 2 * n; j++) cosine[j] = cos(M_PI * j / n);
+  for (size_t i = 0; i <= n; i++) x[i] = mid + half * cosine[i];
+  for (size_t i = 0; i < n; i++)
+    x[n + 1 + i] = mid + half * cos(M_PI * (i + 0.5) / n);
+  const double *vars[2] = {x, NULL};
+  calculate_chunk(program, vars, 0, 2 * n + 1, buffer.data(), f);
+
+  bool finite = true;
+  bool empty = true;
+  double scale = 0;
+  for (size_t i = 0; i < 2 * n + 1; i++) {
+    finite = finite && isfinite(f[i]);
+    empty = empty && !isfinite(f[i]);
+    if (isfinite(f[i]) && fabs(f[i]) > scale) scale = fabs(f[i]);
+  }
+  double bound = tolerance * (scale > 1 ? scale : 1);
+
+  size_t first = coefficients.size();
+  bool good = finite;
+  if (good) {
+    coefficients.resize(first + n + 1);
+    double *c = coefficients.data() + first;
+    for (size_t k = 0; k <= n; k++) {
+      double s = (f[0] + (k % 2 ? -f[n] : f[n])) / 2;
+      for (size_t i = 1; i < n; i++) s += f[i] * cosine[k * i % (2 * n)];
+      c[k] = 2 * s / n;
+    }
+    c[0] /= 2;
+    c[n] /= 2;
+    size_t degree = n;
+    double tail = fabs(c[n]);
+    while (degree > 0 && tail <= bound / 4) tail += fabs(c[--degree]);
+    good = degree + 3 <= n;
+    Piece piece = {from, to, first, degree, false};
+    double p[n];
+    if (good) clenshaw(piece, x + n + 1, n, p);
+    for (size_t i = 0; i < n && good; i++)
+      good = fabs(p[i] - f[n + 1 + i]) <= bound;
+    coefficients.resize(good ? first + degree + 1 : first);
+    if (good) pieces.push_back(piece);
+  }
+
+  int res = 1;
+  if (!good && (empty || depth >= CHEBYSHEV_MAX_DEPTH)) {
+    Piece piece = {from, to, first, 0, true};
+    pieces.push_back(piece);
+  } else if (!good) {
+    res = fit(from, mid, tolerance, depth + 1);
+    if (res == 1) res = fit(mid, to, tolerance, depth + 1);
+  }
+  if (pieces.size() > CHEBYSHEV_MAX_PIECES) res = -1;
+  return res;
+}
+
+// Номер куска, содержащего x, или pieces.size() вне отрезка
+size_t ModelChebyshev::locate(double x) {
+  size_t res = pieces.size();
+  if (x >= pieces.front().from && x <= pieces.back().to)
+    res = std::upper_bound(bounds.begin(), bounds.end(), x) - bounds.begin() -
+          1;
+  return res;
+}
+
+// Схема Кленшоу: внешний цикл по коэффициентам, внутренний по точкам
+// пакета, поэтому он векторизуется
+void ModelChebyshev::clenshaw(const Piece &piece, const double *x,
+                              size_t len, double *result) {
+  const double *c = coefficients.data() + piece.first;
+  double scale = 2 / (piece.to - piece.from);
+  double shift = (piece.to + piece.from) / (piece.to - piece.from);
+  double t[BATCH_CHUNK];
+  double b1[BATCH_CHUNK];
+  double b2[BATCH_CHUNK];
+  for (size_t j = 0; j < len; j++) {
+    t[j] = x[j] * scale - shift;
+    b1[j] = 0;
+    b2[j] = 0;
+  }
+  for (size_t k = piece.degree; k >= 1; k--) {
+    double ck = c[k];
+    for (size_t j = 0; j < len; j++) {
+      double b = 2 * t[j] * b1[j] - b2[j] + ck;
+      b2[j] = b1[j];
+      b1[j] = b;
+    }
+  }
+  for (size_t j = 0; j < len; j++) result[j] = t[j] * b1[j] - b2[j] + c[0];
+}
+
+bool ModelChebyshev::same_program(const Program &a, const Program &b) {
+  bool res = a.code == b.code && a.constants == b.constants &&
+             a.plugins.size() == b.plugins.size() &&
+             a.loops.size() == b.loops.size();
+  for (size_t i = 0; i < a.plugins.size() && res; i++)
+    res = a.plugins[i].scalar == b.plugins[i].scalar &&
+          a.plugins[i].batch == b.plugins[i].batch;
+  for (size_t i = 0; i < a.loops.size() && res; i++)
+    res = a.loops[i].from == b.loops[i].from &&
+          a.loops[i].to == b.loops[i].to &&
+          same_program(a.loops[i].body, b.loops[i].body);
+  return res;
+}
+
+}  // namespace s21
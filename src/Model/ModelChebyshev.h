@@ -0,0 +1,57 @@
+#ifndef CPP3_SMARTCALC_SRC_MODEL_MODELCHEBYSHEV_H
+#define CPP3_SMARTCALC_SRC_MODEL_MODELCHEBYSHEV_H
+#include <stddef.h>
+
+#include <vector>
+
+#include "MainModel.h"
+
+#define CHEBYSHEV_DEGREE 64
+#define CHEBYSHEV_MAX_DEPTH 16
+#define CHEBYSHEV_MAX_PIECES 2048
+#define CHEBYSHEV_TOLERANCE 1e-10
+#define CHEBYSHEV_MIN_COST 8
+
+namespace s21 {
+// Замена дорогого выражения кусочным многочленом Чебышёва на отрезке.
+// Кусок делится пополам, пока ряд по CHEBYSHEV_DEGREE + 1 узлам не сойдётся
+// и не совпадёт с прямым вычислением в промежуточных точках с точностью
+// tolerance * max(1, max|f|). Куски, где этого не добиться (полюс, скачок,
+// край области определения), остаются прямыми и считаются байт-кодом
+class ModelChebyshev : public MainModel {
+ public:
+  int build(const Program &program, double min, double max, double tolerance);
+  bool covers(const Program &program, double min, double max);
+  void evaluate(const double *x, size_t n, double *result);
+  int cost(const Program &program);
+
+  size_t get_pieces();
+  size_t get_direct();
+
+ private:
+  // Многочлен sum c[k] * T_k(t), t = (2x - from - to) / (to - from),
+  // коэффициенты лежат в coefficients с first, degree = 0 у прямого куска
+  typedef struct Piece {
+    double from;
+    double to;
+    size_t first;
+    size_t degree;
+    bool direct;
+  } Piece;
+
+  Program program;
+  bool built = false;
+  std::vector<Piece> pieces;
+  std::vector<double> bounds;
+  std::vector<double> coefficients;
+  std::vector<double> buffer;
+
+  int fit(double from, double to, double tolerance, int depth);
+  size_t locate(double x);
+  void clenshaw(const Piece &piece, const double *x, size_t len,
+                double *result);
+  bool same_program(const Program &a, const Program &b);
+};
+}  // namespace s21
+
+#endif  // CPP3_SMARTCALC_SRC_MODEL_MODELCHEBYSHEV_H
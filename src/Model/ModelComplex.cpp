@@ -0,0 +1,308 @@
+#include "ModelComplex.h"
+
+#include <complex>
+#include <thread>
+
+namespace s21 {
+
+// В комплексном режиме i разбирается как мнимая единица и в определениях
+// функций
+void ModelComplex::set_complex(bool value) {
+  imaginary = value;
+  fold = !value;
+}
+
+bool ModelComplex::get_complex() { return imaginary; }
+
+// Результат как у compile_func: 1 или -2 при ошибке во вводе; y, столбцы
+// данных, циклы и библиотечные функции не принимаются
+int ModelComplex::compile_complex(std::string expression, Program *program) {
+  bool previous = imaginary;
+  bool previous_fold = fold;
+  imaginary = true;
+  fold = false;
+  int res = compile(expression, program);
+  imaginary = previous;
+  fold = previous_fold;
+  for (size_t i = 0; i < program->code.size() && res == 1; i++) {
+    my_type type = (my_type)program->code[i];
+    if (type == var_y || type == var_column || type == var_param ||
+        type == f_plugin || type == f_sum || type == f_prod)
+      res = -2;
+  }
+  return res;
+}
+
+// Вещественная компиляция независимо от режима, выбранного в калькуляторе:
+// один объект функций разделяют калькулятор и график
+int ModelComplex::compile_real(std::string expression, Program *program) {
+  bool previous = imaginary;
+  bool previous_fold = fold;
+  imaginary = false;
+  fold = true;
+  int res = compile(expression, program);
+  imaginary = previous;
+  fold = previous_fold;
+  return res;
+}
+
+// Результат как у final_func: 1, -1 при ошибке в вычислениях, -2 во вводе
+int ModelComplex::calculate_complex(std::string expression, double x_re,
+                                    double x_im, double *re, double *im) {
+  int res = -2;
+  Program program;
+  if (compile_complex(expression, &program) == 1) {
+    res = -1;
+    std::vector<double> buffer(2 * program.depth);
+    double value_re = NAN;
+    double value_im = NAN;
+    complex_chunk(program, &x_re, &x_im, 1, buffer.data(), &value_re,
+                  &value_im);
+    if (!isnan(value_re)) {
+      *re = value_re;
+      *im = value_im;
+      res = 1;
+    }
+  }
+  return res;
+}
+
+// Значения на сетке size x size узлов прямоугольника комплексной
+// плоскости, узел (ix, iy) пишется в [iy * size + ix]. Строки делятся
+// между потоками через одну, каждая считается пакетами по BATCH_CHUNK
+void ModelComplex::calculate_grid(const Program &program, double min_re,
+                                  double max_re, double min_im, double max_im,
+                                  size_t size, double *re, double *im) {
+  double step_re = size > 1 ? (max_re - min_re) / (size - 1) : 0;
+  double step_im = size > 1 ? (max_im - min_im) / (size - 1) : 0;
+  size_t threads = std::thread::hardware_concurrency();
+  if (threads == 0) threads = 1;
+  if (threads > size) threads = size;
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; t++)
+    workers.push_back(std::thread([&, t]() {
+      set_worker();
+      double x_re[BATCH_CHUNK];
+      double x_im[BATCH_CHUNK];
+      std::vector<double> buffer(2 * program.depth * BATCH_CHUNK);
+      for (size_t row = t; row < size; row += threads) {
+        for (size_t first = 0; first < size; first += BATCH_CHUNK) {
+          size_t len =
+              size - first < BATCH_CHUNK ? size - first : BATCH_CHUNK;
+          for (size_t j = 0; j < len; j++) {
+            x_re[j] = min_re + (first + j) * step_re;
+            x_im[j] = min_im + row * step_im;
+          }
+          size_t cell = row * size + first;
+          complex_chunk(program, x_re, x_im, len, buffer.data(), re + cell,
+                        im + cell);
+        }
+      }
+    }));
+  for (size_t t = 0; t < workers.size(); t++) workers[t].join();
+}
+
+// Как calculate_chunk, но в buffer сначала depth слоёв вещественных
+// частей, затем столько же мнимых. NAN в любой части результата делает
+// NAN обе
+void ModelComplex::complex_chunk(const Program &program, const double *x_re,
+                                 const double *x_im, size_t len,
+                                 double *buffer, double *re, double *im) {
+  int top = 0;
+  double *buffer_im = buffer + program.depth * len;
+  const double *constant = program.constants.data();
+  for (size_t i = 0; i < program.code.size(); i++) {
+    my_type type = (my_type)program.code[i];
+    if (type == Number || type == var_i) {
+      double *out_re = buffer + top * len;
+      double *out_im = buffer_im + top * len;
+      double value_re = type == Number ? *constant++ : 0;
+      double value_im = type == var_i ? 1 : 0;
+      for (size_t j = 0; j < len; j++) {
+        out_re[j] = value_re;
+        out_im[j] = value_im;
+      }
+      top++;
+    } else if (type == var_x) {
+      double *out_re = buffer + top * len;
+      double *out_im = buffer_im + top * len;
+      for (size_t j = 0; j < len; j++) {
+        out_re[j] = x_re[j];
+        out_im[j] = x_im[j];
+      }
+      top++;
+    } else if (is_binary(type)) {
+      top--;
+      complex_binary(type, buffer + (top - 1) * len,
+                     buffer_im + (top - 1) * len, buffer + top * len,
+                     buffer_im + top * len, len);
+    } else if (type == f_if) {
+      top -= 2;
+      complex_select(buffer + (top - 1) * len, buffer_im + (top - 1) * len,
+                     buffer + top * len, buffer_im + top * len,
+                     buffer + (top + 1) * len, buffer_im + (top + 1) * len,
+                     len);
+    } else {
+      complex_unary(type, buffer + (top - 1) * len,
+                    buffer_im + (top - 1) * len, len);
+    }
+  }
+  for (size_t j = 0; j < len; j++) {
+    bool fail = isnan(buffer[j] + buffer_im[j]);
+    re[j] = fail ? NAN : buffer[j];
+    im[j] = fail ? NAN : buffer_im[j];
+  }
+}
+
+// Деление при вещественном делителе идёт по частям, тогда на
+// вещественных числах ответ совпадает с вещественным режимом до бита.
+// Сравнения и min/max определены только для вещественных чисел
+void ModelComplex::complex_binary(my_type type, double *a_re, double *a_im,
+                                  const double *b_re, const double *b_im,
+                                  size_t len) {
+  if (type == op_plus)
+    for (size_t j = 0; j < len; j++) {
+      a_re[j] = a_re[j] + b_re[j];
+      a_im[j] = a_im[j] + b_im[j];
+    }
+  if (type == op_minus)
+    for (size_t j = 0; j < len; j++) {
+      a_re[j] = a_re[j] - b_re[j];
+      a_im[j] = a_im[j] - b_im[j];
+    }
+  if (type == op_mul)
+    for (size_t j = 0; j < len; j++) {
+      double r = b_re[j] * a_re[j] - b_im[j] * a_im[j];
+      double m = b_re[j] * a_im[j] + b_im[j] * a_re[j];
+      a_re[j] = r;
+      a_im[j] = m;
+    }
+  if (type == op_div)
+    for (size_t j = 0; j < len; j++) {
+      double d = b_re[j] * b_re[j] + b_im[j] * b_im[j];
+      double r = (a_re[j] * b_re[j] + a_im[j] * b_im[j]) / d;
+      double m = (a_im[j] * b_re[j] - a_re[j] * b_im[j]) / d;
+      double real_r = a_re[j] / b_re[j];
+      double real_m = a_im[j] / b_re[j];
+      bool real = b_im[j] == 0;
+      a_re[j] = d != 0 ? (real ? real_r : r) : NAN;
+      a_im[j] = d != 0 ? (real ? real_m : m) : NAN;
+    }
+  if (type == op_mod)
+    for (size_t j = 0; j < len; j++) {
+      bool real = a_im[j] == 0 && b_im[j] == 0 && b_re[j] != 0;
+      a_re[j] = real ? fmod(a_re[j], b_re[j]) : NAN;
+      a_im[j] = 0;
+    }
+  if (type == op_power) complex_power(a_re, a_im, b_re, b_im, len);
+  if (type == op_equal || type == op_not_equal)
+    for (size_t j = 0; j < len; j++) {
+      bool fail = isnan(a_re[j]) || isnan(a_im[j]) || isnan(b_re[j]) ||
+                  isnan(b_im[j]);
+      bool same = (a_re[j] == b_re[j]) & (a_im[j] == b_im[j]);
+      a_re[j] = fail ? NAN : (double)(same == (type == op_equal));
+      a_im[j] = 0;
+    }
+  if ((type >= op_less && type <= op_greater_eq) || type == f_min ||
+      type == f_max) {
+    calculate_binary(type, a_re, b_re, len);
+    for (size_t j = 0; j < len; j++) {
+      a_re[j] = (a_im[j] == 0) & (b_im[j] == 0) ? a_re[j] : NAN;
+      a_im[j] = 0;
+    }
+  }
+}
+
+// Вещественная степень считается как раньше, целая - умножениями, чтобы
+// i^2 было ровно -1, остальные - через exp(b * ln(a))
+void ModelComplex::complex_power(double *a_re, double *a_im,
+                                 const double *b_re, const double *b_im,
+                                 size_t len) {
+  for (size_t j = 0; j < len; j++) {
+    std::complex<double> a(a_re[j], a_im[j]);
+    std::complex<double> b(b_re[j], b_im[j]);
+    std::complex<double> r = NAN;
+    bool integer = b_im[j] == 0 && b_re[j] == floor(b_re[j]);
+    if (a_im[j] == 0 && b_im[j] == 0 && (a_re[j] >= 0 || integer)) {
+      r = pow(a_re[j], b_re[j]);
+    } else if (integer && fabs(b_re[j]) <= 64) {
+      std::complex<double> p = a;
+      r = 1;
+      for (long n = labs((long)b_re[j]); n > 0; n >>= 1) {
+        if (n & 1) r *= p;
+        p *= p;
+      }
+      if (b_re[j] < 0) r = 1.0 / r;
+    } else if (a_re[j] == 0 && a_im[j] == 0) {
+      if (b_re[j] > 0) r = 0;
+    } else {
+      r = std::exp(b * std::log(a));
+    }
+    a_re[j] = r.real();
+    a_im[j] = r.imag();
+  }
+}
+
+// Точка вещественной области считается вещественной функцией, остальные -
+// главной ветвью комплексной
+void ModelComplex::complex_unary(my_type type, double *re, double *im,
+                                 size_t len) {
+  if (type == f_sin)
+    for (size_t j = 0; j < len; j++) {
+      double r = sin(re[j]) * cosh(im[j]);
+      double m = cos(re[j]) * sinh(im[j]);
+      re[j] = r;
+      im[j] = m;
+    }
+  if (type == f_cos)
+    for (size_t j = 0; j < len; j++) {
+      double r = cos(re[j]) * cosh(im[j]);
+      double m = -sin(re[j]) * sinh(im[j]);
+      re[j] = r;
+      im[j] = m;
+    }
+  if (type == f_tan || (type >= f_asin && type <= f_log))
+    for (size_t j = 0; j < len; j++) {
+      double value = re[j];
+      if (im[j] == 0) calculate_unary(type, &value, 1);
+      std::complex<double> z(re[j], im[j]);
+      if (im[j] == 0 && !isnan(value)) z = value;
+      else if (type == f_tan) z = std::tan(z);
+      else if (type == f_asin) z = std::asin(z);
+      else if (type == f_acos) z = std::acos(z);
+      else if (type == f_atan) z = std::atan(z);
+      else if (type == f_sqrt) z = std::sqrt(z);
+      else if (z == 0.0) z = NAN;
+      else if (type == f_ln) z = std::log(z);
+      else z = std::log10(z);
+      re[j] = z.real();
+      im[j] = z.imag();
+    }
+  if (type == f_abs)
+    for (size_t j = 0; j < len; j++) {
+      re[j] = hypot(re[j], im[j]);
+      im[j] = 0;
+    }
+  if (type == f_arg)
+    for (size_t j = 0; j < len; j++) {
+      re[j] = atan2(im[j], re[j]);
+      im[j] = 0;
+    }
+  if (type == f_conj)
+    for (size_t j = 0; j < len; j++) im[j] = -im[j];
+}
+
+// if(c, a, b): условие истинно, если c не ноль. |re| + |im| - ноль, NAN
+// или истина, как вещественное условие, и каждая часть выбирается
+// вещественным calculate_select
+void ModelComplex::complex_select(double *c_re, double *c_im,
+                                  const double *a_re, const double *a_im,
+                                  const double *b_re, const double *b_im,
+                                  size_t len) {
+  for (size_t j = 0; j < len; j++) c_re[j] = fabs(c_re[j]) + fabs(c_im[j]);
+  memcpy(c_im, c_re, len * sizeof(double));
+  calculate_select(c_re, a_re, b_re, len);
+  calculate_select(c_im, a_im, b_im, len);
+}
+
+}  // namespace s21
@@ -0,0 +1,43 @@
+#ifndef CPP3_SMARTCALC_SRC_MODEL_MODELCOMPLEX_H
+#define CPP3_SMARTCALC_SRC_MODEL_MODELCOMPLEX_H
+#include <string>
+#include <vector>
+
+#include "ModelFunctions.h"
+
+namespace s21 {
+// Вычисление над комплексными числами: i - мнимая единица, abs, arg и conj;
+// sqrt, ln, asin и остальные функции вне вещественной области дают главное
+// значение. Стек хранит вещественные и мнимые части отдельными массивами,
+// поэтому арифметика векторизуется так же, как в вещественном режиме.
+// sum, prod и библиотечные функции остаются вещественными и здесь
+// не принимаются
+class ModelComplex : public ModelFunctions {
+ public:
+  void set_complex(bool value);
+  bool get_complex();
+
+  int compile_complex(std::string expression, Program *program);
+  int compile_real(std::string expression, Program *program);
+  int calculate_complex(std::string expression, double x_re, double x_im,
+                        double *re, double *im);
+  void calculate_grid(const Program &program, double min_re, double max_re,
+                      double min_im, double max_im, size_t size, double *re,
+                      double *im);
+  void complex_chunk(const Program &program, const double *x_re,
+                     const double *x_im, size_t len, double *buffer,
+                     double *re, double *im);
+
+ private:
+  void complex_binary(my_type type, double *a_re, double *a_im,
+                      const double *b_re, const double *b_im, size_t len);
+  void complex_power(double *a_re, double *a_im, const double *b_re,
+                     const double *b_im, size_t len);
+  void complex_unary(my_type type, double *re, double *im, size_t len);
+  void complex_select(double *c_re, double *c_im, const double *a_re,
+                      const double *a_im, const double *b_re,
+                      const double *b_im, size_t len);
+};
+}  // namespace s21
+
+#endif  // CPP3_SMARTCALC_SRC_MODEL_MODELCOMPLEX_H
@@ -1,5 +1,9 @@
 #include "ModelCredit.h"
 
+#include <algorithm>
+#include <charconv>
+#include <thread>
+
 namespace s21 {
 
 std::string ModelCredit::check(std::string sum, std::string time,
@@ -62,9 +66,166 @@ std::string ModelCredit::get_sum_total() {
   return res_out;
 }
 
+// Те же границы, что у valid_sum, valid_time и valid_precent, но для уже
+// прочитанных чисел
+bool ModelCredit::valid_loan(double sum, double time, double precent) {
+  return sum > 0 && sum <= CREDIT_MAX_SUM && time > 0 &&
+         time <= CREDIT_MAX_TIME && time == floor(time) && precent >= 0 &&
+         precent <= CREDIT_MAX_PRECENT;
+}
+
+// Число с шестью знаками после точки, как std::to_string, без строк и
+// локали; возвращает конец записи или p, если до end она не поместилась
+char *ModelCredit::write_fixed(char *p, char *end, double value) {
+  std::to_chars_result res = std::to_chars(p, end, value,
+                                           std::chars_format::fixed, 6);
+  return res.ec == std::errc() ? res.ptr : p;
+}
+
+// Расчёт пакета кредитов по формулам per_month_ann / per_month_diff в
+// замкнутом виде: first и last - первый и последний платежи (у аннуитета
+// совпадают), при нулевой ставке аннуитет - сумма на срок. Строки, не
+// прошедшие valid_loan, получают NAN
+void ModelCredit::calculate_batch(const double *sum, const double *time,
+                                  const double *precent, size_t n,
+                                  std::string type, double *first,
+                                  double *last, double *overpayment,
+                                  double *total) {
+  bool differential = type == "Differentials";
+  parallel_loans(n, [=](size_t begin, size_t end) {
+    for (size_t k = begin; k < end; k++) {
+      if (valid_loan(sum[k], time[k], precent[k])) {
+        double rate = precent[k] / 1200, months = time[k];
+        if (differential) {
+          first[k] = sum[k] / months + sum[k] * rate;
+          last[k] = sum[k] / months * (1 + rate);
+          total[k] = sum[k] + sum[k] * rate * (months + 1) / 2;
+        } else {
+          first[k] = rate == 0 ? sum[k] / months
+                               : sum[k] * ((rate * pow(1 + rate, months)) /
+                                           (pow(1 + rate, months) - 1));
+          last[k] = first[k];
+          total[k] = first[k] * months;
+        }
+        overpayment[k] = total[k] - sum[k];
+      } else {
+        first[k] = last[k] = overpayment[k] = total[k] = NAN;
+      }
+    }
+  });
+}
+
+// Сетка сценариев ставки x сроки x суммы. Платёж и переплата линейны по
+// сумме, поэтому коэффициенты для пар (ставка, срок) считаются один раз
+// (одно pow на пару вместо двух на ячейку), а ячейки - умножением.
+// Выход плотный, [сумма][ставка][срок]: плоскость одной суммы - матрица
+// ставки x сроки в порядке данных QCPColorMapData (ключ - срок)
+void ModelCredit::calculate_grid(const double *precent, size_t rates,
+                                 const int *time, size_t times,
+                                 const double *principal, size_t principals,
+                                 std::string type, double *payment,
+                                 double *overpayment) {
+  bool differential = type == "Differentials";
+  size_t plane = rates * times;
+  std::vector<double> payment_factor(plane), overpayment_factor(plane);
+  double *pay = payment_factor.data(), *over = overpayment_factor.data();
+  parallel_loans(plane, [=](size_t begin, size_t end) {
+    for (size_t k = begin; k < end; k++) {
+      double rate = precent[k / times] / 1200, n = time[k % times];
+      if (n <= 0) {
+        pay[k] = over[k] = NAN;
+      } else if (differential) {
+        pay[k] = 1 / n + rate;
+        over[k] = rate * (n + 1) / 2;
+      } else {
+        double power = pow(1 + rate, n);
+        pay[k] = rate == 0 ? 1 / n : rate * power / (power - 1);
+        over[k] = pay[k] * n - 1;
+      }
+    }
+  });
+  parallel_loans(principals * rates, [=](size_t begin, size_t end) {
+    for (size_t row = begin; row < end; row++) {
+      double sum = principal[row / rates];
+      const double *a = pay + row % rates * times;
+      const double *b = over + row % rates * times;
+      double *out_payment = payment + row * times;
+      double *out_overpayment = overpayment + row * times;
+      for (size_t k = 0; k < times; k++) {
+        out_payment[k] = sum * a[k];
+        out_overpayment[k] = sum * b[k];
+      }
+    }
+  });
+}
+
+// График с реальными датами: платёж k - start + k месяцев с переносом по
+// календарю, проценты за период - ставка на долю года между датами по
+// выбранному соглашению. Аннуитет при разных периодах: с G_k = prod(1 + i_j)
+// остаток обнуляется при A = P / sum(1 / G_k). Выходные массивы длины time
+// выделяет вызывающий
+bool ModelCredit::calculate_dated(double principal, double precent, int time,
+                                  int start,
+                                  ModelCalendar::convention convention,
+                                  std::string type,
+                                  const ModelCalendar &calendar, int *dates,
+                                  double *payment, double *interest,
+                                  double *rest) {
+  int end = valid_loan(principal, time, precent) &&
+                    start >= calendar.first_day() &&
+                    start <= calendar.last_day()
+                ? calendar.add_months(start, time)
+                : -1;
+  bool res = end >= 0 && end < calendar.last_day() - 7;
+  if (res) {
+    bool differential = type == "Differentials";
+    double rate = precent / 100, growth = 1, discount = 0;
+    for (int k = 0, previous = start; k < time; k++) {
+      dates[k] = calendar.adjust(calendar.add_months(start, k + 1));
+      interest[k] = rate * calendar.year_fraction(previous, dates[k],
+                                                  convention);
+      growth *= 1 + interest[k];
+      discount += 1 / growth;
+      previous = dates[k];
+    }
+    double annuity = principal / discount, balance = principal;
+    for (int k = 0; k < time; k++) {
+      double part = differential ? principal / time
+                                 : annuity - balance * interest[k];
+      interest[k] *= balance;
+      balance -= part;
+      payment[k] = part + interest[k];
+      rest[k] = balance;
+    }
+    rest[time - 1] = 0;
+  }
+  return res;
+}
+
+int ModelCredit::get_schedule_rows() { return allow ? time : 0; }
+
+// Строка графика платежей (month от 1) по формулам остатка, без прохода
+// по предыдущим месяцам
+bool ModelCredit::get_schedule_row(int month, double *payment,
+                                   double *principal, double *interest,
+                                   double *rest) {
+  bool res = allow && month >= 1 && month <= time;
+  if (res) {
+    bool differential = type == "Differentials";
+    double before = balance(sum_credit, percent, time, month - 1, differential);
+    *rest = balance(sum_credit, percent, time, month, differential);
+    *interest = before * percent;
+    *principal = before - *rest;
+    *payment = *principal + *interest;
+  }
+  return res;
+}
+
 void ModelCredit::per_month_ann() {
-  ann_payment = sum_credit * ((percent * pow(1 + percent, time)) /
-                              (pow(1 + percent, time) - 1));
+  ann_payment = percent == 0
+                    ? sum_credit / time
+                    : sum_credit * ((percent * pow(1 + percent, time)) /
+                                    (pow(1 + percent, time) - 1));
   sum = ann_payment * time;
   diff = sum - sum_credit;
 }
@@ -81,6 +242,546 @@ void ModelCredit::per_month_diff() {
   diff = sum - sum_credit;
 }
 
+// Годовая ставка (в процентах, как во входных данных) по выданной сумме,
+// разовой комиссии и фактическому графику платежей; NAN - решения нет
+double ModelCredit::calculate_apr(double principal, double fee,
+                                  const double *payments, int time) {
+  return solve_rate(principal - fee, payments, 0, time) * 1200;
+}
+
+// То же для аннуитетных кредитов: payment[k] - ежемесячный платёж
+void ModelCredit::calculate_apr_batch(const double *principal,
+                                      const double *fee,
+                                      const double *payment, const int *time,
+                                      double *apr, size_t n) {
+  parallel_loans(n, [=](size_t begin, size_t end) {
+    for (size_t k = begin; k < end; k++)
+      apr[k] = solve_rate(principal[k] - fee[k], NULL, payment[k], time[k]) *
+               1200;
+  });
+}
+
+// Месячная ставка r: сумма платежей, дисконтированных по r, равна net.
+// Метод Ньютона с аналитической производной; шаг, выходящий за текущую
+// вилку [low, high], заменяется делением пополам
+double ModelCredit::solve_rate(double net, const double *payments,
+                               double payment, int time) {
+  double res = NAN;
+  double total = payment * time, weighted = payment * time * (time + 1.0) / 2;
+  for (int k = 1; payments && k <= time; k++) {
+    total += payments[k - 1];
+    weighted += k * payments[k - 1];
+  }
+  double value = 0, derivative = 0;
+  if (payments) {
+    stream_value(APR_HIGH, payments, time, &value, &derivative);
+  } else {
+    annuity_factor(APR_HIGH, time, &value, &derivative);
+    value *= payment;
+  }
+  if (time > 0 && net > 0 && weighted > 0 && value < net) {
+    double low = APR_LOW, high = APR_HIGH;
+    if (!payments && total > net) {
+      // Для аннуитета при r > 0: payment / net - 1 / n <= r <= payment / net
+      low = fmax(low, payment / net - 1.0 / time);
+      high = fmin(high, payment / net);
+    }
+    double rate = (total - net) / weighted;
+    if (!(rate > low && rate < high)) rate = (low + high) / 2;
+    for (int i = 0; i < APR_MAX_ITERATIONS && isnan(res); i++) {
+      if (payments) {
+        stream_value(rate, payments, time, &value, &derivative);
+      } else {
+        annuity_factor(rate, time, &value, &derivative);
+        value *= payment;
+        derivative *= payment;
+      }
+      value -= net;
+      if (value > 0) low = rate;
+      if (value < 0) high = rate;
+      double next = rate - value / derivative;
+      if (!(next > low && next < high)) next = (low + high) / 2;
+      if (value == 0 || fabs(next - rate) <= 1e-15 * (1 + fabs(rate)))
+        res = next;
+      rate = next;
+    }
+  }
+  return res;
+}
+
+// Наибольшая сумма кредита, при которой платёж (для дифференцированного -
+// первый, самый большой) не превышает payment
+double ModelCredit::max_principal(double payment, double precent, int time,
+                                  std::string type) {
+  return solve_principal(payment, precent / 1200, time,
+                         type == "Differentials");
+}
+
+// Наименьший срок в месяцах (не больше CREDIT_MAX_TIME) с платежом не больше
+// payment; 0 - такого срока нет
+int ModelCredit::min_time(double principal, double payment, double precent,
+                          std::string type) {
+  return solve_time(principal, payment, precent / 1200,
+                    type == "Differentials");
+}
+
+void ModelCredit::max_principal_batch(const double *payment,
+                                      const double *precent, const int *time,
+                                      double *principal, size_t n,
+                                      std::string type) {
+  bool differential = type == "Differentials";
+  parallel_loans(n, [=](size_t begin, size_t end) {
+    for (size_t k = begin; k < end; k++)
+      principal[k] =
+          solve_principal(payment[k], precent[k] / 1200, time[k], differential);
+  });
+}
+
+void ModelCredit::min_time_batch(const double *principal,
+                                 const double *payment, const double *precent,
+                                 int *time, size_t n, std::string type) {
+  bool differential = type == "Differentials";
+  parallel_loans(n, [=](size_t begin, size_t end) {
+    for (size_t k = begin; k < end; k++)
+      time[k] = solve_time(principal[k], payment[k], precent[k] / 1200,
+                           differential);
+  });
+}
+
+// Платёж первого месяца по формулам per_month_ann / per_month_diff
+double ModelCredit::first_payment(double principal, double rate, int time,
+                                  bool differential) {
+  double res = principal / time + principal * rate;
+  if (!differential) {
+    double value = 0, derivative = 0;
+    annuity_factor(rate, time, &value, &derivative);
+    res = principal / value;
+  }
+  return res;
+}
+
+double ModelCredit::solve_principal(double payment, double rate, int time,
+                                    bool differential) {
+  double res = payment / (1.0 / time + rate);
+  if (!differential) {
+    double value = 0, derivative = 0;
+    annuity_factor(rate, time, &value, &derivative);
+    res = payment * value;
+  }
+  return res;
+}
+
+// Срок из обращения формулы платежа; округление вверх уточняется
+// сравнением с платежами соседних сроков
+int ModelCredit::solve_time(double principal, double payment, double rate,
+                               bool differential) {
+  int res = 0;
+  if (payment > principal * rate) {
+    double exact = principal / (payment - principal * rate);
+    if (!differential && rate > 0)
+      exact = -log1p(-principal * rate / payment) / log1p(rate);
+    double time = ceil(exact);
+    if (time < 1) time = 1;
+    if (time <= CREDIT_MAX_TIME + 1) {
+      res = time;
+      while (res > 1 &&
+             first_payment(principal, rate, res - 1, differential) <= payment)
+        res--;
+      while (res <= CREDIT_MAX_TIME &&
+             first_payment(principal, rate, res, differential) > payment)
+        res++;
+      if (res > CREDIT_MAX_TIME) res = 0;
+    }
+  }
+  return res;
+}
+
+// Коэффициент аннуитета a(r) = (1 - (1 + r)^-n) / r и его производная;
+// около нуля - ряд Тейлора, чтобы не терять точность на вычитании
+void ModelCredit::annuity_factor(double rate, int time, double *value,
+                                 double *derivative) {
+  double n = time;
+  if (fabs(rate) < 1e-8) {
+    *value = n - n * (n + 1) / 2 * rate +
+             n * (n + 1) * (n + 2) / 6 * rate * rate;
+    *derivative = -n * (n + 1) / 2 + n * (n + 1) * (n + 2) / 3 * rate;
+  } else {
+    double change = expm1(-n * log1p(rate));
+    *value = -change / rate;
+    *derivative = (n * (1 + change) / (1 + rate) - *value) / rate;
+  }
+}
+
+// Приведённая стоимость произвольного графика и её производная по ставке
+void ModelCredit::stream_value(double rate, const double *payments, int time,
+                               double *value, double *derivative) {
+  double v = 1 / (1 + rate), power = 1;
+  *value = 0;
+  *derivative = 0;
+  for (int k = 1; k <= time; k++) {
+    power *= v;
+    *value += payments[k - 1] * power;
+    *derivative -= k * payments[k - 1] * power * v;
+  }
+}
+
+// Денежный поток портфеля по месяцам: кредит k платит с месяца start[k]
+// (индекс в выходных массивах) в течение time[k] месяцев. Каждый поток
+// копит свои корзины, корзины складываются в фиксированном порядке
+void ModelCredit::calculate_portfolio(const double *principal,
+                                      const double *precent, const int *time,
+                                      const int *start, size_t n,
+                                      std::string type) {
+  size_t months = 0;
+  for (size_t k = 0; k < n; k++)
+    if (start[k] >= 0 && time[k] > 0 && (size_t)(start[k] + time[k]) > months)
+      months = start[k] + time[k];
+  std::vector<size_t> bounds;
+  size_t parts = split_loans(n, bounds), size = 4 * (months + 1);
+  std::vector<double> buckets(parts * size, 0);
+  std::vector<std::thread> workers;
+  for (size_t k = 0; k < parts; k++)
+    workers.emplace_back(portfolio_range, principal, precent, time, start,
+                         bounds[k], bounds[k + 1], type == "Differentials",
+                         months, &buckets[k * size]);
+  for (size_t k = 0; k < parts; k++) {
+    workers[k].join();
+    for (size_t i = 0; k > 0 && i < size; i++)
+      buckets[i] += buckets[k * size + i];
+  }
+  // Постоянные и линейные по месяцу слагаемые лежат в корзинах разностями
+  const double *direct = &buckets[0];
+  const double *step = direct + months + 1;
+  const double *intercept = step + months + 1;
+  const double *slope = intercept + months + 1;
+  portfolio_principal.assign(months, 0);
+  portfolio_interest.assign(months, 0);
+  double sum_step = 0, sum_intercept = 0, sum_slope = 0;
+  for (size_t m = 0; m < months; m++) {
+    sum_step += step[m];
+    sum_intercept += intercept[m];
+    sum_slope += slope[m];
+    portfolio_principal[m] = direct[m] + sum_step;
+    portfolio_interest[m] = sum_intercept + sum_slope * m - direct[m];
+  }
+}
+
+std::vector<double> ModelCredit::get_portfolio_principal() {
+  return portfolio_principal;
+}
+
+std::vector<double> ModelCredit::get_portfolio_interest() {
+  return portfolio_interest;
+}
+
+// Аннуитет: платёж A постоянен на [s, s + n) и пишется разностью, доля
+// основного долга растёт геометрически, (A - rP)(1 + r)^j; проценты -
+// платёж минус доля. Доли с одной ставкой r складываются в свою корзину:
+// c в месяце s и -c(1 + r)^n в месяце s + n, и один проход
+// v = v(1 + r) + e[m] на ставку даёт их сумму по месяцам, так что кредит
+// стоит O(1), а весь портфель - O(n + ставки * месяцы). Ставки сверх
+// PORTFOLIO_RATES разных в одной части считаются помесячно, O(срок).
+// Дифференцированный: P / n и r(P - P / n (m - s)) на [s, s + n) -
+// по O(1) записей в разностные корзины
+void ModelCredit::portfolio_range(const double *principal,
+                                  const double *precent, const int *time,
+                                  const int *start, size_t begin, size_t end,
+                                  bool differential, size_t months,
+                                  double *bucket) {
+  double *direct = bucket;
+  double *step = direct + months + 1;
+  double *intercept = step + months + 1;
+  double *slope = intercept + months + 1;
+  std::vector<double> rates, geometric;
+  for (size_t k = begin; k < end; k++) {
+    if (start[k] < 0 || time[k] <= 0) continue;
+    double rate = precent[k] / 1200, sum = principal[k];
+    int s = start[k], n = time[k];
+    if (differential) {
+      double part = sum / n;
+      step[s] += part;
+      step[s + n] -= part;
+      intercept[s] += rate * sum + rate * part * s;
+      intercept[s + n] -= rate * sum + rate * part * s;
+      slope[s] -= rate * part;
+      slope[s + n] += rate * part;
+    } else {
+      double payment = first_payment(sum, rate, n, false);
+      double part = payment - sum * rate;
+      intercept[s] += payment;
+      intercept[s + n] -= payment;
+      size_t r = std::find(rates.begin(), rates.end(), rate) - rates.begin();
+      if (r == rates.size() && rates.size() < PORTFOLIO_RATES) {
+        rates.push_back(rate);
+        geometric.resize(rates.size() * (months + 1), 0);
+      }
+      if (r < rates.size()) {
+        double *e = &geometric[r * (months + 1)];
+        e[s] += part;
+        e[s + n] -= part * pow(1 + rate, n);
+      } else {
+        double growth = 1 + rate;
+        for (int j = 0; j < n; j++, part *= growth) direct[s + j] += part;
+      }
+    }
+  }
+  for (size_t r = 0; r < rates.size(); r++) {
+    const double *e = &geometric[r * (months + 1)];
+    double value = 0;
+    for (size_t m = 0; m < months; m++) {
+      value = value * (1 + rates[r]) + e[m];
+      direct[m] += value;
+    }
+  }
+}
+
+ModelCredit::Sensitivity ModelCredit::calculate_sensitivity(
+    double principal, double precent, int time, std::string type) {
+  return sensitivity(principal, precent, time, type == "Differentials");
+}
+
+void ModelCredit::calculate_sensitivity_batch(const double *principal,
+                                              const double *precent,
+                                              const int *time,
+                                              Sensitivity *result, size_t n,
+                                              std::string type) {
+  bool differential = type == "Differentials";
+  parallel_loans(n, [=](size_t begin, size_t end) {
+    for (size_t k = begin; k < end; k++)
+      result[k] = sensitivity(principal[k], precent[k], time[k], differential);
+  });
+}
+
+// Платёж и полная сумма выплат считаются по формулам per_month_ann /
+// per_month_diff в дуальных числах; дюрация и выпуклость - по
+// дисконтированному графику платежей, где дуальна доходность
+ModelCredit::Sensitivity ModelCredit::sensitivity(double principal,
+                                                  double precent, int time,
+                                                  bool differential) {
+  Dual sum = dual_constant(principal);
+  Dual rate = dual_constant(precent / 1200);
+  Dual months = dual_constant(time);
+  rate.rate = 1.0 / 1200;
+  months.time = 1;
+  Dual payment, total;
+  if (differential) {
+    Dual interest = dual_mul(sum, rate);
+    payment = dual_add(dual_div(sum, months), interest);
+    Dual half = dual_mul(dual_add(months, dual_constant(1)),
+                         dual_constant(0.5));
+    total = dual_add(sum, dual_mul(interest, half));
+  } else {
+    payment = dual_div(sum, dual_annuity(rate, months));
+    total = dual_mul(payment, months);
+  }
+  Dual yield = dual_constant(precent / 1200);
+  yield.rate = 1.0 / 12;
+  Dual discount = dual_div(dual_constant(1), dual_add(dual_constant(1), yield));
+  Dual power = dual_constant(1), value = dual_constant(0);
+  double r = precent / 1200, part = principal / time;
+  for (int k = 1; k <= time; k++) {
+    double flow = differential ? part + (principal - part * (k - 1)) * r
+                               : payment.value;
+    power = dual_mul(power, discount);
+    value = dual_add(value, dual_mul(power, dual_constant(flow)));
+  }
+  Sensitivity res;
+  res.payment = payment.value;
+  res.payment_rate = payment.rate;
+  res.payment_time = payment.time;
+  res.total = total.value;
+  res.total_rate = total.rate;
+  res.total_time = total.time;
+  res.duration = -value.rate / value.value;
+  res.convexity = value.rate2 / value.value;
+  return res;
+}
+
+ModelCredit::Refinance ModelCredit::calculate_refinance(
+    double principal, double precent, int time, int paid, double new_precent,
+    int new_time, double cost, std::string type) {
+  return refinance(principal, precent / 1200, time, paid, new_precent / 1200,
+                   new_time, cost, type == "Differentials");
+}
+
+// Сетка предложений для одного кредита: result[i * times + j] - ставка
+// new_precent[i] и срок new_time[j]
+void ModelCredit::calculate_refinance_batch(
+    double principal, double precent, int time, int paid,
+    const double *new_precent, size_t rates, const int *new_time, size_t times,
+    double cost, Refinance *result, std::string type) {
+  bool differential = type == "Differentials";
+  parallel_loans(rates * times, [=](size_t begin, size_t end) {
+    for (size_t k = begin; k < end; k++)
+      result[k] = refinance(principal, precent / 1200, time, paid,
+                            new_precent[k / times] / 1200,
+                            new_time[k % times], cost, differential);
+  });
+}
+
+// Старый кредит после paid платежей - это кредит на остаток с тем же
+// платежом на time - paid месяцев, новый - на тот же остаток. Выигрыш за
+// k месяцев g(k) - разница накопленных процентов по формулам остатка.
+// Месячная разница процентов меняет знак не больше одного раза: если она
+// сначала положительна, g растёт до максимума и дальше падает, иначе
+// (ставка выше, срок короче) сначала падает, а после окончания нового
+// кредита растёт. Месяц смены знака и первый месяц с g(k) >= cost на
+// возрастающем участке ищутся двоичным поиском
+ModelCredit::Refinance ModelCredit::refinance(double principal, double rate,
+                                              int time, int paid,
+                                              double new_rate, int new_time,
+                                              double cost, bool differential) {
+  Refinance res = {0, 0, 0, 0};
+  if (paid >= 0 && paid < time && new_time > 0) {
+    double rest = balance(principal, rate, time, paid, differential);
+    int months = time - paid, horizon = months > new_time ? months : new_time;
+    res.balance = rest;
+    res.payment = first_payment(rest, new_rate, new_time, differential);
+    res.saving = interest_paid(rest, rate, months, months, differential) -
+                 interest_paid(rest, new_rate, new_time, new_time,
+                               differential) -
+                 cost;
+    auto saved = [&](int k) {
+      return rate * balance(rest, rate, months, k - 1, differential) >
+             new_rate * balance(rest, new_rate, new_time, k - 1, differential);
+    };
+    auto gain = [&](int k) {
+      return interest_paid(rest, rate, months, k, differential) -
+             interest_paid(rest, new_rate, new_time, k, differential);
+    };
+    // последний месяц, где знак разницы тот же, что в первом
+    bool rising = saved(1);
+    int low = 0, high = horizon;
+    while (low < high) {
+      int k = (low + high + 1) / 2;
+      if (saved(k) == rising)
+        low = k;
+      else
+        high = k - 1;
+    }
+    int from = rising ? 1 : low + 1, to = rising ? low : horizon;
+    if (!rising && gain(1) >= cost) {
+      res.break_even = 1;
+    } else if (from <= to && gain(to) >= cost) {
+      while (from < to) {
+        int k = (from + to) / 2;
+        if (gain(k) >= cost)
+          to = k;
+        else
+          from = k + 1;
+      }
+      res.break_even = from;
+    }
+  }
+  return res;
+}
+
+// Остаток долга после months платежей (months <= time)
+double ModelCredit::balance(double principal, double rate, int time,
+                            int months, bool differential) {
+  double res = 0;
+  if (months < time) {
+    res = principal - principal / time * months;
+    if (!differential) {
+      double value = 0, rest = 0, derivative = 0;
+      annuity_factor(rate, time, &value, &derivative);
+      annuity_factor(rate, time - months, &rest, &derivative);
+      res = principal * rest / value;
+    }
+  }
+  return res;
+}
+
+// Проценты, уплаченные за первые months платежей: выплаты минус погашенный
+// основной долг
+double ModelCredit::interest_paid(double principal, double rate, int time,
+                                  int months, bool differential) {
+  if (months > time) months = time;
+  double paid = first_payment(principal, rate, time, false) * months;
+  if (differential)
+    paid = principal / time * months +
+           rate * principal * (months - months * (months - 1.0) / (2 * time));
+  return paid - (principal - balance(principal, rate, time, months,
+                                     differential));
+}
+
+// Коэффициент аннуитета, как annuity_factor, но в дуальных числах
+ModelCredit::Dual ModelCredit::dual_annuity(Dual rate, Dual time) {
+  Dual res;
+  if (fabs(rate.value) < 1e-8) {
+    Dual next = dual_add(time, dual_constant(1));
+    Dual first = dual_mul(dual_mul(time, next), dual_constant(-0.5));
+    Dual second = dual_mul(dual_mul(time, next),
+                           dual_add(time, dual_constant(2)));
+    second = dual_mul(second, dual_constant(1.0 / 6));
+    Dual series = dual_add(first, dual_mul(second, rate));
+    res = dual_add(time, dual_mul(rate, series));
+  } else {
+    double x = log1p(rate.value);
+    Dual log = dual_apply(rate, x, 1 / (1 + rate.value),
+                          -1 / ((1 + rate.value) * (1 + rate.value)));
+    Dual power = dual_mul(dual_mul(time, log), dual_constant(-1));
+    double e = exp(power.value);
+    Dual change = dual_apply(power, expm1(power.value), e, e);
+    res = dual_div(dual_mul(change, dual_constant(-1)), rate);
+  }
+  return res;
+}
+
+ModelCredit::Dual ModelCredit::dual_constant(double value) {
+  Dual res = {value, 0, 0, 0};
+  return res;
+}
+
+ModelCredit::Dual ModelCredit::dual_add(Dual a, Dual b) {
+  Dual res = {a.value + b.value, a.rate + b.rate, a.time + b.time,
+              a.rate2 + b.rate2};
+  return res;
+}
+
+ModelCredit::Dual ModelCredit::dual_mul(Dual a, Dual b) {
+  Dual res = {a.value * b.value, a.rate * b.value + a.value * b.rate,
+              a.time * b.value + a.value * b.time,
+              a.rate2 * b.value + 2 * a.rate * b.rate + a.value * b.rate2};
+  return res;
+}
+
+ModelCredit::Dual ModelCredit::dual_div(Dual a, Dual b) {
+  double inverse = 1 / b.value;
+  return dual_mul(a, dual_apply(b, inverse, -inverse * inverse,
+                                2 * inverse * inverse * inverse));
+}
+
+// f(a) по значению f и производным f', f'' в точке a.value
+ModelCredit::Dual ModelCredit::dual_apply(Dual a, double f, double df,
+                                          double ddf) {
+  Dual res = {f, df * a.rate, df * a.time,
+              ddf * a.rate * a.rate + df * a.rate2};
+  return res;
+}
+
+// Пакет кредитов делится на непрерывные диапазоны по числу ядер
+size_t ModelCredit::split_loans(size_t n, std::vector<size_t> &bounds) {
+  size_t threads = std::thread::hardware_concurrency();
+  if (threads == 0) threads = 1;
+  size_t part = (n + threads - 1) / threads;
+  if (part < BATCH_CHUNK) part = BATCH_CHUNK;
+  bounds.clear();
+  for (size_t begin = 0; begin < n; begin += part) bounds.push_back(begin);
+  bounds.push_back(n);
+  return bounds.size() - 1;
+}
+
+void ModelCredit::parallel_loans(size_t n,
+                                 std::function<void(size_t, size_t)> body) {
+  std::vector<size_t> bounds;
+  size_t parts = split_loans(n, bounds);
+  std::vector<std::thread> workers;
+  for (size_t k = 0; k < parts; k++)
+    workers.emplace_back(body, bounds[k], bounds[k + 1]);
+  for (size_t k = 0; k < parts; k++) workers[k].join();
+}
+
 bool ModelCredit::valid_time(std::string text) {
   bool res = false;
   unsigned int tmp = 0;
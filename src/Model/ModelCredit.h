@@ -1,12 +1,45 @@
 #ifndef CPP3_SMARTCALC_SRC_MODEL_MODELCREDIT_H
 #define CPP3_SMARTCALC_SRC_MODEL_MODELCREDIT_H
+#include <functional>
 #include <iostream>
 
 #include "MainModel.h"
+#include "ModelCalendar.h"
+
+#define APR_LOW -0.99
+#define APR_HIGH 10.0
+#define APR_MAX_ITERATIONS 100
+#define CREDIT_MAX_TIME 1200
+#define CREDIT_MAX_SUM 100000000
+#define CREDIT_MAX_PRECENT 100
+#define PORTFOLIO_RATES 64
 
 namespace s21 {
 class ModelCredit {
  public:
+  // Производные по ставке - на один процентный пункт годовой ставки, по
+  // сроку - на месяц; дюрация (в годах) и выпуклость - по годовой
+  // доходности графика платежей
+  typedef struct Sensitivity {
+    double payment;
+    double payment_rate;
+    double payment_time;
+    double total;
+    double total_rate;
+    double total_time;
+    double duration;
+    double convexity;
+  } Sensitivity;
+
+  // Рефинансирование остатка: месяц окупаемости (0 - не окупается) и
+  // чистая экономия на процентах за вычетом расходов
+  typedef struct Refinance {
+    double balance;
+    double payment;
+    int break_even;
+    double saving;
+  } Refinance;
+
   std::string check(std::string sum, std::string time, std::string precent,
                     std::string type);
   void calculate();
@@ -15,7 +48,74 @@ class ModelCredit {
   std::string get_overpayment();
   std::string get_sum_total();
 
+  static bool valid_loan(double sum, double time, double precent);
+  static char *write_fixed(char *p, char *end, double value);
+  void calculate_batch(const double *sum, const double *time,
+                       const double *precent, size_t n, std::string type,
+                       double *first, double *last, double *overpayment,
+                       double *total);
+
+  void calculate_grid(const double *precent, size_t rates, const int *time,
+                      size_t times, const double *principal, size_t principals,
+                      std::string type, double *payment, double *overpayment);
+  bool calculate_dated(double principal, double precent, int time, int start,
+                       ModelCalendar::convention convention, std::string type,
+                       const ModelCalendar &calendar, int *dates,
+                       double *payment, double *interest, double *rest);
+
+  int get_schedule_rows();
+  bool get_schedule_row(int month, double *payment, double *principal,
+                        double *interest, double *rest);
+
+  double calculate_apr(double principal, double fee, const double *payments,
+                       int time);
+  void calculate_apr_batch(const double *principal, const double *fee,
+                           const double *payment, const int *time,
+                           double *apr, size_t n);
+
+  double max_principal(double payment, double precent, int time,
+                       std::string type);
+  int min_time(double principal, double payment, double precent,
+               std::string type);
+  void max_principal_batch(const double *payment, const double *precent,
+                           const int *time, double *principal, size_t n,
+                           std::string type);
+  void min_time_batch(const double *principal, const double *payment,
+                      const double *precent, int *time, size_t n,
+                      std::string type);
+
+  void calculate_portfolio(const double *principal, const double *precent,
+                           const int *time, const int *start, size_t n,
+                           std::string type);
+  std::vector<double> get_portfolio_principal();
+  std::vector<double> get_portfolio_interest();
+
+  Sensitivity calculate_sensitivity(double principal, double precent, int time,
+                                    std::string type);
+  void calculate_sensitivity_batch(const double *principal,
+                                   const double *precent, const int *time,
+                                   Sensitivity *result, size_t n,
+                                   std::string type);
+
+  Refinance calculate_refinance(double principal, double precent, int time,
+                                int paid, double new_precent, int new_time,
+                                double cost, std::string type);
+  void calculate_refinance_batch(double principal, double precent, int time,
+                                 int paid, const double *new_precent,
+                                 size_t rates, const int *new_time,
+                                 size_t times, double cost, Refinance *result,
+                                 std::string type);
+
  private:
+  // Дуальное число: значение, производные по ставке (rate) и сроку (time) и
+  // вторая производная по ставке (rate2) - всё за один проход по формуле
+  typedef struct Dual {
+    double value;
+    double rate;
+    double time;
+    double rate2;
+  } Dual;
+
   int allow = 0;
 
   double sum_credit = 0;
@@ -29,6 +129,8 @@ class ModelCredit {
   double sum = 0;
   double diff = 0;
 
+  std::vector<double> portfolio_principal, portfolio_interest;
+
   bool valid_sum(std::string text);
   bool valid_time(std::string text);
   bool valid_precent(std::string text);
@@ -38,6 +140,41 @@ class ModelCredit {
 
   void per_month_ann();
   void per_month_diff();
+
+  static double solve_rate(double net, const double *payments, double payment,
+                           int time);
+  static double first_payment(double principal, double rate, int time,
+                              bool differential);
+  static double solve_principal(double payment, double rate, int time,
+                                bool differential);
+  static int solve_time(double principal, double payment, double rate,
+                        bool differential);
+  static void annuity_factor(double rate, int time, double *value,
+                             double *derivative);
+  static void stream_value(double rate, const double *payments, int time,
+                           double *value, double *derivative);
+  static void portfolio_range(const double *principal, const double *precent,
+                              const int *time, const int *start, size_t begin,
+                              size_t end, bool differential, size_t months,
+                              double *bucket);
+  static Sensitivity sensitivity(double principal, double precent, int time,
+                                 bool differential);
+  static Refinance refinance(double principal, double rate, int time,
+                             int paid, double new_rate, int new_time,
+                             double cost, bool differential);
+  static double balance(double principal, double rate, int time, int months,
+                        bool differential);
+  static double interest_paid(double principal, double rate, int time,
+                              int months, bool differential);
+  static Dual dual_annuity(Dual rate, Dual time);
+  static Dual dual_constant(double value);
+  static Dual dual_add(Dual a, Dual b);
+  static Dual dual_mul(Dual a, Dual b);
+  static Dual dual_div(Dual a, Dual b);
+  static Dual dual_apply(Dual a, double f, double df, double ddf);
+  static size_t split_loans(size_t n, std::vector<size_t> &bounds);
+  static void parallel_loans(size_t n,
+                             std::function<void(size_t, size_t)> body);
 };
 }  // namespace s21
 
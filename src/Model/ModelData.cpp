@@ -0,0 +1,362 @@
+#include "ModelData.h"
+
+#include <fcntl.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <thread>
+
+namespace s21 {
+
+// Файл отображается в память целиком; *.bin - пары (x, y) типа double,
+// остальные файлы читаются как CSV
+std::string ModelData::load(std::string path) {
+  std::string res_out = "";
+  names.clear();
+  columns.clear();
+  rows = 0;
+  struct stat info;
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0 || fstat(fd, &info) != 0) {
+    res_out = "Cannot open file";
+  } else if (info.st_size == 0) {
+    res_out = "Empty file";
+  } else {
+    size_t size = info.st_size;
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+      res_out = "Cannot open file";
+    } else {
+      madvise(map, size, MADV_SEQUENTIAL);
+      if (path.size() >= 4 && path.compare(path.size() - 4, 4, ".bin") == 0)
+        res_out = load_binary((const char *)map, size);
+      else
+        res_out = load_csv((const char *)map, size);
+      munmap(map, size);
+    }
+  }
+  if (fd >= 0) close(fd);
+  if (!res_out.empty()) {
+    names.clear();
+    columns.clear();
+    rows = 0;
+  }
+  return res_out;
+}
+
+size_t ModelData::get_rows() { return rows; }
+
+size_t ModelData::get_columns() { return columns.size(); }
+
+std::string ModelData::get_name(size_t column) {
+  std::string res = "";
+  if (column < names.size()) res = names[column];
+  return res;
+}
+
+const double *ModelData::get_column(size_t column) {
+  const double *res = NULL;
+  if (column < columns.size()) res = columns[column].data();
+  return res;
+}
+
+// Новый столбец вычисляется по выражению над уже загруженными столбцами,
+// например "ln(price)*qty"
+std::string ModelData::add_column(std::string name, std::string expression) {
+  std::string res_out = "";
+  Stack *program = NULL;
+  if (rows == 0) {
+    res_out = "No data";
+  } else if (!column_name(name) || names.size() >= DATA_MAX_COLUMNS ||
+             std::find(names.begin(), names.end(), name) != names.end()) {
+    res_out = "Incorrect name";
+  } else if (!compile_columns(expression, &program)) {
+    res_out = "Incorrect input";
+  } else {
+    std::vector<double> result(rows);
+    evaluate_columns(program, result.data());
+    names.push_back(name);
+    columns.push_back(result);
+  }
+  remove_node(&program);
+  return res_out;
+}
+
+// В выражениях над столбцами нет переменных x и y, поэтому так можно
+// называть столбцы, в том числе оба столбца файла *.bin
+bool ModelData::column_name(const std::string &name) {
+  return valid_name(name) || name == "x" || name == "y";
+}
+
+bool ModelData::compile_columns(std::string expression, Stack **program) {
+  bool res = false;
+  if (expression.size() < MAX_SIZE_STRING) {
+    std::vector<std::string> usable = names;
+    for (size_t c = 0; c < usable.size(); c++) {
+      std::string name = usable[c];
+      usable[c] = "";
+      if (column_name(name)) usable[c] = name;
+    }
+    char input[MAX_SIZE_STRING] = "";
+    char trimmed[MAX_SIZE_STRING] = "";
+    char masked[MAX_SIZE_STRING] = "";
+    strcpy(input, expression.c_str());
+    trim_input(input, trimmed);
+    mask_names(trimmed, masked, usable);
+    if (valid_input(masked)) {
+      build_named_program(trimmed, program, usable, var_column);
+      res = true;
+      for (Stack *node = *program; node; node = node->next)
+        if (node->type == var_x || node->type == var_y) res = false;
+    }
+  }
+  return res;
+}
+
+// Строки делятся на непрерывные диапазоны по числу ядер, каждый диапазон
+// считается пакетно блоками по BATCH_CHUNK строк
+void ModelData::evaluate_columns(Stack *program, double *result) {
+  size_t threads = std::thread::hardware_concurrency();
+  if (threads == 0) threads = 1;
+  size_t part = (rows + threads - 1) / threads;
+  if (part < BATCH_CHUNK) part = BATCH_CHUNK;
+  std::vector<std::thread> workers;
+  for (size_t begin = 0; begin < rows; begin += part) {
+    size_t len = rows - begin < part ? rows - begin : part;
+    workers.emplace_back([this, program, result, begin, len]() {
+      set_worker();
+      std::vector<const double *> vars(2 + columns.size(), NULL);
+      for (size_t c = 0; c < columns.size(); c++)
+        vars[2 + c] = columns[c].data() + begin;
+      calculate_batch(program, vars.data(), result + begin, len);
+    });
+  }
+  for (size_t k = 0; k < workers.size(); k++) workers[k].join();
+}
+
+std::string ModelData::load_binary(const char *data, size_t size) {
+  std::string res_out = "";
+  if (size % (2 * sizeof(double)) != 0) {
+    res_out = "Incorrect binary file";
+  } else {
+    const double *values = (const double *)data;
+    rows = size / (2 * sizeof(double));
+    names = {"x", "y"};
+    columns.assign(2, std::vector<double>(rows));
+    for (size_t r = 0; r < rows; r++) {
+      columns[0][r] = values[2 * r];
+      columns[1][r] = values[2 * r + 1];
+    }
+  }
+  return res_out;
+}
+
+// Файл делится на куски по границам строк: сначала каждый поток считает
+// строки в своём куске, затем разбирает их сразу в нужные позиции столбцов
+std::string ModelData::load_csv(const char *data, size_t size) {
+  std::string res_out = "";
+  const char *end = data + size;
+  if (size >= 3 && memcmp(data, "\xEF\xBB\xBF", 3) == 0) data += 3;
+  const char *line_end = (const char *)memchr(data, '\n', end - data);
+  if (line_end == NULL) line_end = end;
+  char delimiter = find_delimiter(data, line_end);
+  const char *body = data;
+  if (read_header(data, line_end, delimiter))
+    body = line_end < end ? line_end + 1 : end;
+
+  if (names.size() > DATA_MAX_COLUMNS) {
+    res_out = "Too many columns";
+  } else {
+    size_t threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    std::vector<const char *> bounds = {body};
+    for (size_t k = 1; k < threads; k++) {
+      const char *p = body + (end - body) * k / threads;
+      if (p < bounds.back()) p = bounds.back();
+      const char *newline = (const char *)memchr(p, '\n', end - p);
+      bounds.push_back(newline ? newline + 1 : end);
+    }
+    bounds.push_back(end);
+
+    std::vector<size_t> offsets(threads + 1, 0);
+    std::vector<std::thread> workers;
+    for (size_t k = 0; k < threads; k++)
+      workers.emplace_back([this, &bounds, &offsets, k]() {
+        offsets[k + 1] = count_lines(bounds[k], bounds[k + 1]);
+      });
+    for (size_t k = 0; k < threads; k++) workers[k].join();
+    for (size_t k = 0; k < threads; k++) offsets[k + 1] += offsets[k];
+
+    rows = offsets[threads];
+    columns.assign(names.size(), std::vector<double>(rows));
+    workers.clear();
+    for (size_t k = 0; k < threads; k++)
+      workers.emplace_back([this, &bounds, &offsets, delimiter, k]() {
+        parse_lines(bounds[k], bounds[k + 1], delimiter, offsets[k]);
+      });
+    for (size_t k = 0; k < threads; k++) workers[k].join();
+  }
+  return res_out;
+}
+
+char ModelData::find_delimiter(const char *line, const char *end) {
+  const char candidates[3] = {',', ';', '\t'};
+  char res = ',';
+  int best = 0;
+  for (int k = 0; k < 3; k++) {
+    int count = 0;
+    for (const char *p = line; p < end; p++)
+      if (*p == candidates[k]) count++;
+    if (count > best) {
+      best = count;
+      res = candidates[k];
+    }
+  }
+  return res;
+}
+
+// Первая строка считается заголовком, если хотя бы одно её поле не число
+bool ModelData::read_header(const char *line, const char *end,
+                            char delimiter) {
+  bool header = false;
+  std::vector<std::string> fields;
+  const char *p = line;
+  bool last = false;
+  while (!last) {
+    const char *delim = (const char *)memchr(p, delimiter, end - p);
+    const char *b = p;
+    const char *e = delim ? delim : end;
+    while (b < e && (*b == ' ' || *b == '"')) b++;
+    while (e > b && (e[-1] == ' ' || e[-1] == '"' || e[-1] == '\r')) e--;
+    double value = 0;
+    if (b != e && parse_number(b, e, &value) != e) header = true;
+    fields.push_back(std::string(b, e));
+    last = delim == NULL;
+    if (!last) p = delim + 1;
+  }
+  for (size_t c = 0; c < fields.size(); c++) {
+    if (!header || fields[c].empty()) fields[c] = "col" + std::to_string(c + 1);
+  }
+  names = fields;
+  return header;
+}
+
+size_t ModelData::count_lines(const char *begin, const char *end) {
+  size_t count = 0;
+  const char *p = begin;
+  while (p < end) {
+    const char *newline = (const char *)memchr(p, '\n', end - p);
+    count++;
+    p = newline ? newline + 1 : end;
+  }
+  return count;
+}
+
+void ModelData::parse_lines(const char *begin, const char *end,
+                            char delimiter, size_t row) {
+  const char *p = begin;
+  while (p < end) p = parse_line(p, end, delimiter, row++);
+}
+
+// Пустые и нечисловые поля становятся NAN, чтобы номера строк не сдвигались
+const char *ModelData::parse_line(const char *line, const char *end,
+                                  char delimiter, size_t row) {
+  const char *eol = (const char *)memchr(line, '\n', end - line);
+  if (eol == NULL) eol = end;
+  const char *p = line;
+  for (size_t c = 0; c < columns.size(); c++) {
+    double value = NAN;
+    const char *delim = (const char *)memchr(p, delimiter, eol - p);
+    const char *field_end = delim ? delim : eol;
+    while (p < field_end && (*p == ' ' || *p == '"')) p++;
+    const char *next = parse_number(p, field_end, &value);
+    if (next != NULL) {
+      while (next < field_end &&
+             (*next == ' ' || *next == '"' || *next == '\r'))
+        next++;
+      if (next != field_end) value = NAN;
+    }
+    columns[c][row] = value;
+    p = delim ? delim + 1 : eol;
+  }
+  return eol < end ? eol + 1 : end;
+}
+
+// Короткие десятичные числа собираются точно (мантисса до 2^53 и порядок
+// до 22), остальные передаются в strtod
+const char *ModelData::parse_number(const char *p, const char *end,
+                                    double *value) {
+  static const double powers[23] = {
+      1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  const char *s = p;
+  bool negative = false;
+  bool exact = true;
+  int digits = 0;
+  int exponent = 0;
+  uint64_t mantissa = 0;
+  if (s < end && (*s == '-' || *s == '+')) negative = *s++ == '-';
+  const char *start = s;
+  while (s < end && *s >= '0' && *s <= '9') {
+    if (digits < 19) {
+      mantissa = mantissa * 10 + (*s - '0');
+      if (mantissa != 0) digits++;
+    } else {
+      exact = false;
+    }
+    s++;
+  }
+  if (s < end && *s == '.') {
+    s++;
+    while (s < end && *s >= '0' && *s <= '9') {
+      if (digits < 19) {
+        mantissa = mantissa * 10 + (*s - '0');
+        if (mantissa != 0) digits++;
+        exponent--;
+      } else {
+        exact = false;
+      }
+      s++;
+    }
+  }
+  bool any = s > start && !(s == start + 1 && *start == '.');
+  if (any && s < end && (*s == 'e' || *s == 'E')) {
+    const char *e = s + 1;
+    bool e_negative = false;
+    int e_value = 0;
+    if (e < end && (*e == '-' || *e == '+')) e_negative = *e++ == '-';
+    if (e < end && *e >= '0' && *e <= '9') {
+      while (e < end && *e >= '0' && *e <= '9') {
+        if (e_value < 10000) e_value = e_value * 10 + (*e - '0');
+        e++;
+      }
+      exponent += e_negative ? -e_value : e_value;
+      s = e;
+    }
+  }
+
+  const char *res = NULL;
+  if (any) {
+    res = s;
+    if (exact && mantissa <= (1ULL << 53) && exponent >= -22 &&
+        exponent <= 22) {
+      double tmp = (double)mantissa;
+      tmp = exponent < 0 ? tmp / powers[-exponent] : tmp * powers[exponent];
+      *value = negative ? -tmp : tmp;
+    } else if (s - p < DATA_MAX_NUMBER) {
+      char buffer[DATA_MAX_NUMBER] = "";
+      memcpy(buffer, p, s - p);
+      *value = strtod(buffer, NULL);
+    } else {
+      res = NULL;
+    }
+  }
+  return res;
+}
+
+}  // namespace s21
@@ -0,0 +1,47 @@
+#ifndef CPP3_SMARTCALC_SRC_MODEL_MODELDATA_H
+#define CPP3_SMARTCALC_SRC_MODEL_MODELDATA_H
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "MainModel.h"
+
+#define DATA_MAX_COLUMNS 64
+#define DATA_MAX_NUMBER 64
+
+namespace s21 {
+class ModelData : public MainModel {
+ public:
+  std::string load(std::string path);
+  std::string add_column(std::string name, std::string expression);
+
+  size_t get_rows();
+  size_t get_columns();
+  std::string get_name(size_t column);
+  const double *get_column(size_t column);
+
+ private:
+  std::vector<std::string> names;
+  std::vector<std::vector<double>> columns;
+  size_t rows = 0;
+
+  std::string load_csv(const char *data, size_t size);
+  std::string load_binary(const char *data, size_t size);
+
+  char find_delimiter(const char *line, const char *end);
+  bool read_header(const char *line, const char *end, char delimiter);
+  size_t count_lines(const char *begin, const char *end);
+  void parse_lines(const char *begin, const char *end, char delimiter,
+                   size_t row);
+  const char *parse_line(const char *line, const char *end, char delimiter,
+                         size_t row);
+  const char *parse_number(const char *p, const char *end, double *value);
+
+  bool column_name(const std::string &name);
+  bool compile_columns(std::string expression, Stack **program);
+  void evaluate_columns(Stack *program, double *result);
+};
+}  // namespace s21
+
+#endif  // CPP3_SMARTCALC_SRC_MODEL_MODELDATA_H
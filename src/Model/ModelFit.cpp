@@ -0,0 +1,329 @@
+#include "ModelFit.h"
+
+#include <chrono>
+#include <thread>
+
+namespace s21 {
+
+// Подбор параметров выражения (например "a*sin(b*x)+c" с параметрами
+// "a=1, b=2, c") по методу Левенберга-Марквардта. Якобиан считается
+// конечными разностями пакетным вычислителем, точки делятся между потоками.
+std::string ModelFit::fit(std::string expression, std::string parameters,
+                          const double *x, const double *y, size_t n) {
+  std::string res_out = "";
+  Stack *list = NULL;
+  this->expression = expression;
+  iterations = 0;
+  residual = 0;
+  time = 0;
+  converged = false;
+  data_x = x;
+  data_y = y;
+  rows = n;
+  if (n == 0 || x == NULL || y == NULL) {
+    res_out = "No data";
+  } else if (!read_parameters(parameters)) {
+    res_out = "Incorrect parameters";
+  } else if (!compile(expression, &list)) {
+    res_out = "Incorrect input";
+  } else {
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    pack_program(list, &program);
+    depth = program.depth;
+    size_t count = 0;
+    if (depth <= 0 || !isfinite(calculate_cost(values, &count)) ||
+        count == 0) {
+      res_out = "Incorrect initial parameters";
+    } else {
+      levenberg_marquardt();
+    }
+    time = std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - start)
+               .count();
+  }
+  remove_node(&list);
+  if (!res_out.empty()) this->expression = "";
+  return res_out;
+}
+
+// Кривая с найденными параметрами в точках x
+void ModelFit::calculate_curve(const double *x, double *y, size_t n) {
+  Stack *curve = NULL;
+  if (!expression.empty() && compile(expression, &curve)) {
+    std::vector<const double *> vars(2 + values.size(), NULL);
+    vars[0] = x;
+    for (size_t k = 0; k < values.size(); k++) vars[2 + k] = &values[k];
+    calculate_batch(curve, vars.data(), y, n);
+  } else {
+    for (size_t j = 0; j < n; j++) y[j] = NAN;
+  }
+  remove_node(&curve);
+}
+
+size_t ModelFit::get_parameters() { return values.size(); }
+
+std::string ModelFit::get_name(size_t k) {
+  std::string res = "";
+  if (k < names.size()) res = names[k];
+  return res;
+}
+
+double ModelFit::get_value(size_t k) {
+  double res = NAN;
+  if (k < values.size()) res = values[k];
+  return res;
+}
+
+int ModelFit::get_iterations() { return iterations; }
+
+double ModelFit::get_residual() { return residual; }
+
+double ModelFit::get_time() { return time; }
+
+bool ModelFit::get_converged() { return converged; }
+
+// Параметры: "a=1, b, c=-0.5"; без значения начальное приближение 1
+bool ModelFit::read_parameters(std::string parameters) {
+  bool res = true;
+  names.clear();
+  values.clear();
+  std::string text = "";
+  for (size_t i = 0; i < parameters.size(); i++)
+    if (parameters[i] != ' ') text += parameters[i];
+  size_t begin = 0;
+  while (res && begin <= text.size()) {
+    size_t end = text.find(',', begin);
+    if (end == std::string::npos) end = text.size();
+    std::string item = text.substr(begin, end - begin);
+    size_t equal = item.find('=');
+    std::string name = item.substr(0, equal);
+    double value = 1;
+    if (equal != std::string::npos) {
+      char *rest = NULL;
+      std::string number = item.substr(equal + 1);
+      value = strtod(number.c_str(), &rest);
+      if (number.empty() || *rest != '\0' || !isfinite(value)) res = false;
+    }
+    for (size_t k = 0; k < names.size() && res; k++)
+      if (names[k] == name) res = false;
+    if (!valid_name(name)) res = false;
+    names.push_back(name);
+    values.push_back(value);
+    begin = end + 1;
+  }
+  if (names.size() > FIT_MAX_PARAMS) res = false;
+  return res;
+}
+
+bool ModelFit::compile(std::string text, Stack **result) {
+  bool res = false;
+  if (text.size() < MAX_SIZE_STRING) {
+    char input[MAX_SIZE_STRING] = "";
+    char trimmed[MAX_SIZE_STRING] = "";
+    char masked[MAX_SIZE_STRING] = "";
+    strcpy(input, text.c_str());
+    trim_input(input, trimmed);
+    mask_names(trimmed, masked, names);
+    if (valid_input(masked)) {
+      build_named_program(trimmed, result, names, var_param);
+      res = true;
+    }
+  }
+  return res;
+}
+
+void ModelFit::levenberg_marquardt() {
+  size_t count = 0;
+  size_t p = values.size();
+  double cost = calculate_cost(values, &count);
+  double lambda = 1e-3;
+  std::vector<double> jtj, jtr, delta, trial(p);
+  while (!converged && iterations < FIT_MAX_ITERATIONS) {
+    calculate_normal(values, jtj, jtr);
+    bool accepted = false;
+    while (!accepted && !converged) {
+      std::vector<double> a = jtj;
+      for (size_t k = 0; k < p; k++)
+        a[k * p + k] += lambda * (jtj[k * p + k] > 0 ? jtj[k * p + k] : 1);
+      double trial_cost = INFINITY;
+      if (solve(a, jtr, delta)) {
+        for (size_t k = 0; k < p; k++) trial[k] = values[k] + delta[k];
+        trial_cost = calculate_cost(trial, &count);
+      }
+      if (trial_cost < cost) {
+        bool small_step = true;
+        for (size_t k = 0; k < p; k++)
+          if (fabs(delta[k]) > 1e-10 * (fabs(values[k]) + 1e-10))
+            small_step = false;
+        if (cost - trial_cost <= 1e-12 * cost || small_step) converged = true;
+        values = trial;
+        cost = trial_cost;
+        lambda = lambda / 10 > 1e-12 ? lambda / 10 : 1e-12;
+        accepted = true;
+      } else {
+        lambda *= 10;
+        if (lambda > 1e16) converged = true;
+      }
+    }
+    iterations++;
+    if (cost == 0) converged = true;
+  }
+  residual = sqrt(cost / count);
+}
+
+// Диапазон строк делится на непрерывные части по числу ядер; частичные
+// суммы складываются в одном и том же порядке, поэтому результат не зависит
+// от планирования потоков
+size_t ModelFit::split_rows(std::vector<size_t> &bounds) {
+  size_t threads = std::thread::hardware_concurrency();
+  if (threads == 0) threads = 1;
+  size_t part = (rows + threads - 1) / threads;
+  if (part < BATCH_CHUNK) part = BATCH_CHUNK;
+  bounds.clear();
+  for (size_t begin = 0; begin < rows; begin += part) bounds.push_back(begin);
+  bounds.push_back(rows);
+  return bounds.size() - 1;
+}
+
+double ModelFit::calculate_cost(const std::vector<double> &p, size_t *count) {
+  std::vector<size_t> bounds;
+  size_t parts = split_rows(bounds);
+  std::vector<double> costs(parts, 0);
+  std::vector<size_t> counts(parts, 0);
+  std::vector<std::thread> workers;
+  for (size_t k = 0; k < parts; k++)
+    workers.emplace_back([this, &p, &bounds, &costs, &counts, k]() {
+      set_worker();
+      cost_range(p, bounds[k], bounds[k + 1], &costs[k], &counts[k]);
+    });
+  double cost = 0;
+  *count = 0;
+  for (size_t k = 0; k < parts; k++) {
+    workers[k].join();
+    cost += costs[k];
+    *count += counts[k];
+  }
+  return cost;
+}
+
+void ModelFit::calculate_normal(const std::vector<double> &p,
+                                std::vector<double> &jtj,
+                                std::vector<double> &jtr) {
+  size_t n = p.size();
+  std::vector<size_t> bounds;
+  size_t parts = split_rows(bounds);
+  std::vector<double> partial_jtj(parts * n * n, 0), partial_jtr(parts * n, 0);
+  std::vector<std::thread> workers;
+  for (size_t k = 0; k < parts; k++)
+    workers.emplace_back(
+        [this, &p, &bounds, &partial_jtj, &partial_jtr, n, k]() {
+          set_worker();
+          normal_range(p, bounds[k], bounds[k + 1], &partial_jtj[k * n * n],
+                       &partial_jtr[k * n]);
+        });
+  jtj.assign(n * n, 0);
+  jtr.assign(n, 0);
+  for (size_t k = 0; k < parts; k++) {
+    workers[k].join();
+    for (size_t a = 0; a < n * n; a++) jtj[a] += partial_jtj[k * n * n + a];
+    for (size_t a = 0; a < n; a++) jtr[a] += partial_jtr[k * n + a];
+  }
+  for (size_t a = 0; a < n; a++)
+    for (size_t b = a + 1; b < n; b++) jtj[a * n + b] = jtj[b * n + a];
+}
+
+// Точки с NAN в данных пропускаются; если модель не определена хотя бы в
+// одной точке, сумма квадратов становится бесконечной
+void ModelFit::cost_range(const std::vector<double> &p, size_t begin,
+                          size_t end, double *cost, size_t *count) {
+  std::vector<double> buffer(depth * BATCH_CHUNK), f(BATCH_CHUNK);
+  std::vector<const double *> vars(2 + p.size(), NULL);
+  vars[0] = data_x;
+  for (size_t k = 0; k < p.size(); k++) vars[2 + k] = &p[k];
+  for (size_t offset = begin; offset < end; offset += BATCH_CHUNK) {
+    size_t len = end - offset < BATCH_CHUNK ? end - offset : BATCH_CHUNK;
+    calculate_chunk(program, vars.data(), offset, len, buffer.data(),
+                    f.data());
+    for (size_t j = 0; j < len; j++) {
+      double y = data_y[offset + j];
+      if (!isnan(y) && !isnan(data_x[offset + j])) {
+        double r = isnan(f[j]) ? INFINITY : y - f[j];
+        *cost += r * r;
+        *count += 1;
+      }
+    }
+  }
+}
+
+void ModelFit::normal_range(const std::vector<double> &p, size_t begin,
+                            size_t end, double *jtj, double *jtr) {
+  size_t n = p.size();
+  std::vector<double> local = p, h(n);
+  std::vector<double> buffer(depth * BATCH_CHUNK), f(BATCH_CHUNK),
+      shifted(n * BATCH_CHUNK), jacobian(n);
+  std::vector<const double *> vars(2 + n, NULL);
+  vars[0] = data_x;
+  for (size_t k = 0; k < n; k++) {
+    vars[2 + k] = &local[k];
+    h[k] = 1e-7 * (fabs(p[k]) > 1 ? fabs(p[k]) : 1);
+  }
+  for (size_t offset = begin; offset < end; offset += BATCH_CHUNK) {
+    size_t len = end - offset < BATCH_CHUNK ? end - offset : BATCH_CHUNK;
+    calculate_chunk(program, vars.data(), offset, len, buffer.data(),
+                    f.data());
+    for (size_t k = 0; k < n; k++) {
+      local[k] = p[k] + h[k];
+      calculate_chunk(program, vars.data(), offset, len, buffer.data(),
+                      shifted.data() + k * BATCH_CHUNK);
+      local[k] = p[k];
+    }
+    for (size_t j = 0; j < len; j++) {
+      double r = data_y[offset + j] - f[j];
+      bool defined = !isnan(r) && !isnan(data_x[offset + j]);
+      for (size_t k = 0; k < n && defined; k++) {
+        jacobian[k] = (shifted[k * BATCH_CHUNK + j] - f[j]) / h[k];
+        if (!isfinite(jacobian[k])) defined = false;
+      }
+      for (size_t a = 0; a < n && defined; a++) {
+        jtr[a] += jacobian[a] * r;
+        for (size_t b = 0; b <= a; b++)
+          jtj[a * n + b] += jacobian[a] * jacobian[b];
+      }
+    }
+  }
+}
+
+// Метод Гаусса с выбором главного элемента
+bool ModelFit::solve(std::vector<double> a, std::vector<double> b,
+                     std::vector<double> &x) {
+  bool res = true;
+  size_t n = b.size();
+  for (size_t col = 0; col < n && res; col++) {
+    size_t pivot = col;
+    for (size_t row = col + 1; row < n; row++)
+      if (fabs(a[row * n + col]) > fabs(a[pivot * n + col])) pivot = row;
+    if (!(fabs(a[pivot * n + col]) > 0)) {
+      res = false;
+    } else {
+      for (size_t k = 0; k < n; k++)
+        std::swap(a[col * n + k], a[pivot * n + k]);
+      std::swap(b[col], b[pivot]);
+      for (size_t row = col + 1; row < n; row++) {
+        double factor = a[row * n + col] / a[col * n + col];
+        for (size_t k = col; k < n; k++)
+          a[row * n + k] -= factor * a[col * n + k];
+        b[row] -= factor * b[col];
+      }
+    }
+  }
+  x.assign(n, 0);
+  for (size_t row = n; row-- > 0 && res;) {
+    double sum = b[row];
+    for (size_t k = row + 1; k < n; k++) sum -= a[row * n + k] * x[k];
+    x[row] = sum / a[row * n + row];
+  }
+  return res;
+}
+
+}  // namespace s21
@@ -0,0 +1,57 @@
+#ifndef CPP3_SMARTCALC_SRC_MODEL_MODELFIT_H
+#define CPP3_SMARTCALC_SRC_MODEL_MODELFIT_H
+#include <string>
+#include <vector>
+
+#include "MainModel.h"
+
+#define FIT_MAX_PARAMS 16
+#define FIT_MAX_ITERATIONS 200
+
+namespace s21 {
+class ModelFit : public MainModel {
+ public:
+  std::string fit(std::string expression, std::string parameters,
+                  const double *x, const double *y, size_t n);
+  void calculate_curve(const double *x, double *y, size_t n);
+
+  size_t get_parameters();
+  std::string get_name(size_t k);
+  double get_value(size_t k);
+  int get_iterations();
+  double get_residual();
+  double get_time();
+  bool get_converged();
+
+ private:
+  std::string expression = "";
+  std::vector<std::string> names;
+  std::vector<double> values;
+  int iterations = 0;
+  double residual = 0;
+  double time = 0;
+  bool converged = false;
+
+  Program program;
+  int depth = 0;
+  const double *data_x = NULL;
+  const double *data_y = NULL;
+  size_t rows = 0;
+
+  bool read_parameters(std::string parameters);
+  bool compile(std::string text, Stack **result);
+  void levenberg_marquardt();
+  double calculate_cost(const std::vector<double> &p, size_t *count);
+  void calculate_normal(const std::vector<double> &p, std::vector<double> &jtj,
+                        std::vector<double> &jtr);
+  void cost_range(const std::vector<double> &p, size_t begin, size_t end,
+                  double *cost, size_t *count);
+  void normal_range(const std::vector<double> &p, size_t begin, size_t end,
+                    double *jtj, double *jtr);
+  bool solve(std::vector<double> a, std::vector<double> b,
+             std::vector<double> &x);
+  size_t split_rows(std::vector<size_t> &bounds);
+};
+}  // namespace s21
+
+#endif  // CPP3_SMARTCALC_SRC_MODEL_MODELFIT_H
@@ -0,0 +1,581 @@
+#include "ModelFunctions.h"
+
+#include <dlfcn.h>
+
+#include <thread>
+
+namespace s21 {
+
+ModelFunctions::~ModelFunctions() {
+  for (size_t k = 0; k < handles.size(); k++) dlclose(handles[k]);
+}
+
+// Определение "f(a,b)=a^2+sin(b)". Тело может вызывать уже определённые
+// функции и использовать x; повторное определение заменяет функцию, но не
+// меняет тел, в которые она уже подставлена
+std::string ModelFunctions::define(std::string definition) {
+  std::string res_out = "";
+  std::string text = "";
+  for (size_t i = 0; i < definition.size(); i++)
+    if (definition[i] != ' ') text += definition[i];
+  size_t equal = text.find('=');
+  size_t open = text.find('(');
+  bool valid = equal != std::string::npos && open != std::string::npos &&
+               open < equal && text[equal - 1] == ')';
+  std::string name = "";
+  std::vector<std::string> params;
+  if (valid) {
+    name = text.substr(0, open);
+    std::string list = text.substr(open + 1, equal - open - 2);
+    size_t begin = 0;
+    while (valid && !list.empty() && begin <= list.size()) {
+      size_t end = list.find(',', begin);
+      if (end == std::string::npos) end = list.size();
+      std::string param = list.substr(begin, end - begin);
+      for (size_t k = 0; k < params.size() && valid; k++)
+        if (params[k] == param) valid = false;
+      if (!valid_name(param) || param == name || is_used(param))
+        valid = false;
+      params.push_back(param);
+      begin = end + 1;
+    }
+    if (!valid_name(name) || params.size() > FUNCTION_MAX_PARAMS)
+      valid = false;
+    for (size_t k = 0; k < plugin_names.size() && valid; k++)
+      if (plugin_names[k] == name) valid = false;
+  }
+  Program body;
+  if (!valid) {
+    res_out = "Incorrect definition";
+  } else if (compile_text(text.substr(equal + 1), params, &body) != 1) {
+    res_out = "Incorrect input";
+  } else {
+    int index = find(name);
+    if (index < 0) {
+      index = functions.size();
+      functions.push_back(Function());
+    }
+    functions[index].name = name;
+    functions[index].params = params.size();
+    functions[index].body = body;
+  }
+  return res_out;
+}
+
+// Имена через запятую; функции ищутся в библиотеке один раз здесь, в
+// программу попадают готовые указатели
+std::string ModelFunctions::load(std::string path, std::string names) {
+  std::string res_out = "";
+  std::vector<std::string> list;
+  std::string text = "";
+  for (size_t i = 0; i < names.size(); i++)
+    if (names[i] != ' ') text += names[i];
+  size_t begin = 0;
+  while (res_out.empty() && begin <= text.size()) {
+    size_t end = text.find(',', begin);
+    if (end == std::string::npos) end = text.size();
+    std::string name = text.substr(begin, end - begin);
+    for (size_t k = 0; k < list.size(); k++)
+      if (list[k] == name) res_out = "Incorrect name";
+    if (!valid_name(name) || is_used(name)) res_out = "Incorrect name";
+    list.push_back(name);
+    begin = end + 1;
+  }
+  if (res_out.empty() &&
+      plugins.size() + list.size() > FUNCTION_MAX_PLUGINS)
+    res_out = "Too many functions";
+  void *handle = NULL;
+  if (res_out.empty()) {
+    handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (handle == NULL) res_out = "Cannot open library";
+  }
+  std::vector<Plugin> found;
+  for (size_t k = 0; k < list.size() && handle != NULL && res_out.empty();
+       k++) {
+    Plugin plugin;
+    plugin.scalar = (double (*)(double))dlsym(handle, list[k].c_str());
+    plugin.batch = (void (*)(const double *, double *, size_t))dlsym(
+        handle, (list[k] + "_batch").c_str());
+    if (plugin.scalar == NULL || plugin.batch == NULL)
+      res_out = "No function " + list[k];
+    found.push_back(plugin);
+  }
+  if (res_out.empty()) {
+    handles.push_back(handle);
+    plugin_names.insert(plugin_names.end(), list.begin(), list.end());
+    plugins.insert(plugins.end(), found.begin(), found.end());
+  } else if (handle != NULL) {
+    dlclose(handle);
+  }
+  return res_out;
+}
+
+// Результат как у compile_func: 1 или -2 при ошибке во вводе
+int ModelFunctions::compile(std::string expression, Program *program) {
+  std::string text = "";
+  for (size_t i = 0; i < expression.size(); i++)
+    if (expression[i] != ' ') text += expression[i];
+  return compile_text(text, {}, program);
+}
+
+// Результат как у final_func: 1, -1 при ошибке в вычислениях, -2 во вводе
+int ModelFunctions::calculate(std::string expression, double x,
+                              double *result) {
+  int res = -2;
+  Program program;
+  if (compile(expression, &program) == 1) {
+    res = -1;
+    std::vector<double> buffer(program.depth);
+    double y = 0;
+    double tmp = NAN;
+    const double *vars[2] = {&x, &y};
+    if (parallel &&
+        subtrees.build(program, std::thread::hardware_concurrency()) > 0)
+      tmp = subtrees.evaluate(vars);
+    else
+      calculate_chunk(program, vars, 0, 1, buffer.data(), &tmp);
+    if (!isnan(tmp)) {
+      *result = tmp;
+      res = 1;
+    }
+  }
+  return res;
+}
+
+// Есть ли в выражении вызов пользовательской функции
+bool ModelFunctions::is_call(std::string expression) {
+  bool res = false;
+  int index = 0;
+  size_t len = 0;
+  for (size_t i = 0; i < expression.size() && !res; i++)
+    if (match_call(expression, i, &index) > 0 ||
+        match_builtin(expression, i, &len) != 0)
+      res = true;
+  return res;
+}
+
+// Похоже ли на определение "name(...)=": первое '=' одиночное, а не часть
+// сравнения <=, >=, == или !=, и перед ним имя со скобкой. Сравнения
+// вида x<=1 остаются выражениями
+bool ModelFunctions::is_definition(std::string text) {
+  size_t equal = text.find('=');
+  bool res = equal != std::string::npos;
+  if (res) {
+    char before = equal > 0 ? text[equal - 1] : ' ';
+    char after = equal + 1 < text.size() ? text[equal + 1] : ' ';
+    res = before != '<' && before != '>' && before != '!' && after != '=';
+  }
+  size_t i = 0;
+  while (i < text.size() && text[i] == ' ') i++;
+  size_t begin = i;
+  while (res && i < equal && (isalnum(text[i]) || text[i] == '_')) i++;
+  while (res && i < equal && text[i] == ' ') i++;
+  return res && i > begin && isalpha(text[begin]) && i < equal &&
+         text[i] == '(';
+}
+
+size_t ModelFunctions::get_count() { return functions.size(); }
+
+void ModelFunctions::clear() { functions.clear(); }
+
+void ModelFunctions::set_parallel(bool value) { parallel = value; }
+
+int ModelFunctions::find(const std::string &name) {
+  int res = -1;
+  for (size_t k = 0; k < functions.size() && res < 0; k++)
+    if (functions[k].name == name) res = k;
+  return res;
+}
+
+bool ModelFunctions::is_used(const std::string &name) {
+  bool res = find(name) >= 0;
+  for (size_t k = 0; k < plugin_names.size() && !res; k++)
+    if (plugin_names[k] == name) res = true;
+  return res;
+}
+
+// Имя функции с позиции i, перед которым нет буквы, цифры или '_' и за
+// которым идёт '('; возвращает длину имени или 0. Номера библиотечных
+// функций идут после пользовательских
+size_t ModelFunctions::match_call(std::string &text, size_t i, int *index) {
+  size_t res = 0;
+  if (i == 0 || !(isalnum(text[i - 1]) || text[i - 1] == '_')) {
+    std::vector<std::string> names;
+    for (size_t k = 0; k < functions.size(); k++)
+      names.push_back(functions[k].name);
+    names.insert(names.end(), plugin_names.begin(), plugin_names.end());
+    res = match_name(&text[0], i, names, index);
+    if (res > 0 && text[i + res] != '(') res = 0;
+  }
+  return res;
+}
+
+// Встроенная операция с аргументами через запятую с позиции i: f_sum,
+// f_prod, f_if, f_min, f_max, f_arg или f_conj, иначе 0; len - длина имени
+MainModel::my_type ModelFunctions::match_builtin(std::string &text, size_t i,
+                                                 size_t *len) {
+  static const char *names[] = {"sum(", "prod(", "if(",  "min(",
+                                "max(", "arg(",  "conj("};
+  static const my_type types[] = {f_sum, f_prod, f_if, f_min,
+                                  f_max, f_arg,  f_conj};
+  my_type res = my_type(0);
+  if (i == 0 || !(isalnum(text[i - 1]) || text[i - 1] == '_')) {
+    for (size_t k = 0; k < sizeof(names) / sizeof(*names); k++) {
+      if (text.compare(i, strlen(names[k]), names[k]) == 0) {
+        res = types[k];
+        *len = strlen(names[k]) - 1;
+      }
+    }
+  }
+  return res;
+}
+
+// Отдельно стоящее i в комплексном режиме
+bool ModelFunctions::match_unit(std::string &text, size_t i) {
+  bool res = imaginary && text[i] == 'i' &&
+             (i == 0 || !(isalnum(text[i - 1]) || text[i - 1] == '_'));
+  if (res && i + 1 < text.size())
+    res = !(isalnum(text[i + 1]) || text[i + 1] == '_' || text[i + 1] == '(');
+  return res;
+}
+
+// Каждый вызов заменяется в тексте именем "#k", которое проверяется и
+// разбирается как параметр с номером params.size() + k; в собранный
+// байт-код на его место подставляется тело функции с аргументами
+int ModelFunctions::compile_text(std::string text,
+                                 const std::vector<std::string> &params,
+                                 Program *program) {
+  int res = -2;
+  std::string masked = "";
+  std::vector<std::string> names = params;
+  std::vector<Program> calls;
+  bool valid =
+      text.size() < MAX_SIZE_STRING && text.find('#') == std::string::npos;
+  for (size_t i = 0; valid && i < text.size(); i++) {
+    int index = 0;
+    size_t len = 0;
+    my_type builtin = match_builtin(text, i, &len);
+    if (builtin == 0) len = match_call(text, i, &index);
+    if (match_unit(text, i)) {
+      calls.push_back(Program());
+      calls.back().code.push_back(var_i);
+      calls.back().depth = 1;
+      names.push_back("#" + std::to_string(calls.size() - 1));
+      masked += names.back();
+    } else if (builtin != 0) {
+      std::vector<std::string> args;
+      size_t end = i + len;
+      calls.push_back(Program());
+      valid = read_call(text, &end, &args);
+      if (valid && (builtin == f_sum || builtin == f_prod))
+        valid = compile_loop(builtin, args, params, &calls.back()) == 1;
+      else if (valid)
+        valid = compile_select(builtin, args, params, &calls.back()) == 1;
+      names.push_back("#" + std::to_string(calls.size() - 1));
+      masked += names.back();
+      i = end;
+    } else if (len > 0) {
+      std::vector<std::string> args;
+      size_t end = i + len;
+      size_t plugin = index - functions.size();
+      size_t count = plugin < plugins.size() ? 1 : functions[index].params;
+      valid = read_call(text, &end, &args) && args.size() == count;
+      std::vector<Program> values(args.size());
+      std::vector<const Program *> table;
+      for (size_t k = 0; k < args.size() && valid; k++) {
+        valid = compile_text(args[k], params, &values[k]) == 1;
+        table.push_back(&values[k]);
+      }
+      calls.push_back(Program());
+      if (valid && plugin < plugins.size()) {
+        calls.back() = values[0];
+        calls.back().code.push_back(f_plugin);
+        calls.back().code.push_back(plugin);
+      } else if (valid) {
+        valid = substitute(functions[index].body, table, &calls.back());
+      }
+      names.push_back("#" + std::to_string(calls.size() - 1));
+      masked += names.back();
+      i = end;
+    } else {
+      masked += text[i];
+    }
+  }
+  if (valid && masked.size() < MAX_SIZE_STRING) {
+    char input[MAX_SIZE_STRING] = "";
+    char check[MAX_SIZE_STRING] = "";
+    strcpy(input, masked.c_str());
+    mask_names(input, check, names);
+    if (valid_input(check)) {
+      Stack *list = NULL;
+      Program caller;
+      build_named_program(input, &list, names, var_param);
+      pack_program(list, &caller);
+      remove_node(&list);
+      std::vector<const Program *> table(params.size(), NULL);
+      for (size_t k = 0; k < calls.size(); k++) table.push_back(&calls[k]);
+      program->code.clear();
+      program->constants.clear();
+      program->plugins = plugins;
+      program->loops.clear();
+      if (caller.depth > 0 && substitute(caller, table, program)) {
+        if (fold) fold_constants(program);
+        program->depth = code_depth(*program);
+        if (program->depth > 0) res = 1;
+      }
+    }
+  }
+  return res;
+}
+
+// Аргументы вызова, i - позиция '(' после имени; запятые внутри вложенных
+// скобок не делят аргументы. i переходит на закрывающую скобку
+bool ModelFunctions::read_call(const std::string &text, size_t *i,
+                               std::vector<std::string> *args) {
+  bool res = false;
+  int depth = 0;
+  size_t begin = *i + 1;
+  for (size_t j = *i; j < text.size() && !res; j++) {
+    if (text[j] == '(') depth++;
+    if (text[j] == ')') depth--;
+    if ((text[j] == ',' && depth == 1) || depth == 0) {
+      args->push_back(text.substr(begin, j - begin));
+      begin = j + 1;
+    }
+    if (depth == 0) {
+      res = true;
+      *i = j;
+    }
+  }
+  if (res && args->size() == 1 && (*args)[0].empty()) args->clear();
+  return res;
+}
+
+// sum(k,a,b,expr): границы - целые числа, тело компилируется с k как
+// ещё одним параметром
+int ModelFunctions::compile_loop(my_type type,
+                                 const std::vector<std::string> &args,
+                                 const std::vector<std::string> &params,
+                                 Program *program) {
+  int res = -2;
+  Program from, to, body;
+  std::vector<std::string> names = params;
+  bool valid = args.size() == 4 && valid_name(args[0]) && !is_used(args[0]);
+  for (size_t k = 0; k < params.size() && valid; k++)
+    if (params[k] == args[0]) valid = false;
+  if (valid) {
+    names.push_back(args[0]);
+    valid = compile_text(args[1], params, &from) == 1 && is_integer(from) &&
+            compile_text(args[2], params, &to) == 1 && is_integer(to) &&
+            compile_text(args[3], names, &body) == 1 && body.loops.empty();
+  }
+  Loop loop;
+  if (valid && to.constants[0] - from.constants[0] < LOOP_MAX_TERMS &&
+      shift_frame(body, params.size(), &loop.body)) {
+    loop.from = from.constants[0];
+    loop.to = to.constants[0];
+    *program = Program();
+    program->plugins = plugins;
+    program->depth = 1;
+    program->code.push_back(type);
+    program->code.push_back(0);
+    program->loops.push_back(loop);
+    if (fold) fold_constants(program);
+    res = 1;
+  }
+  return res;
+}
+
+// if(c,a,b), min(a,b), max(a,b), arg(z), conj(z): программы аргументов
+// подряд, затем операция, которая берёт их со стека
+int ModelFunctions::compile_select(my_type type,
+                                   const std::vector<std::string> &args,
+                                   const std::vector<std::string> &params,
+                                   Program *program) {
+  int res = -2;
+  size_t count = type == f_min || type == f_max ? 2 : 1;
+  if (type == f_if) count = 3;
+  bool valid = args.size() == count;
+  *program = Program();
+  program->plugins = plugins;
+  for (size_t k = 0; k < args.size() && valid; k++) {
+    Program value;
+    valid = compile_text(args[k], params, &value) == 1 &&
+            substitute(value, {}, program);
+  }
+  if (valid) {
+    program->code.push_back(type);
+    if (fold) fold_constants(program);
+    program->depth = code_depth(*program);
+    res = 1;
+  }
+  return res;
+}
+
+// Переход в систему тела цикла: параметр index (переменная цикла)
+// становится var_x, x - var_y; y в теле цикла не допускается. index 256
+// не совпадает ни с одним номером - программа без переменной цикла
+bool ModelFunctions::shift_frame(const Program &program, size_t index,
+                                 Program *result) {
+  bool res = program.loops.empty();
+  *result = program;
+  result->code.clear();
+  for (size_t i = 0; i < program.code.size() && res; i++) {
+    my_type type = (my_type)program.code[i];
+    if (type == var_y) res = false;
+    if (type == var_x) type = var_y;
+    if (type == var_param && program.code[i + 1] == index) {
+      type = var_x;
+      i++;
+    }
+    result->code.push_back(type);
+    if (type == var_column || type == var_param || type == f_plugin)
+      result->code.push_back(program.code[++i]);
+  }
+  return res;
+}
+
+// Зависит ли тело цикла от внешнего x или параметров
+bool ModelFunctions::depends_on_outer(const Program &program) {
+  bool res = false;
+  for (size_t i = 0; i < program.code.size(); i++) {
+    my_type type = (my_type)program.code[i];
+    if (type == var_y || type == var_param) res = true;
+    if (type == var_column || type == var_param || type == f_plugin) i++;
+  }
+  return res;
+}
+
+bool ModelFunctions::is_integer(const Program &program) {
+  bool res = program.code.size() == 1 && program.code[0] == Number;
+  if (res) {
+    double value = program.constants[0];
+    res = value == floor(value) && fabs(value) < 1e15;
+  }
+  return res;
+}
+
+// Копия программы, в которой параметр k заменён программой table[k]
+// (NULL - оставить параметр); false, если код вырос больше предела.
+// Циклы перенумеровываются, в их тела подставляются table[k] в системе
+// тела цикла
+bool ModelFunctions::substitute(const Program &program,
+                                const std::vector<const Program *> &table,
+                                Program *result) {
+  bool res = true;
+  const double *constant = program.constants.data();
+  std::vector<Program> shifted;
+  std::vector<const Program *> inner;
+  if (!program.loops.empty()) {
+    shifted.resize(table.size());
+    for (size_t k = 0; k < table.size() && res; k++) {
+      inner.push_back(NULL);
+      if (table[k] != NULL) {
+        res = shift_frame(*table[k], 256, &shifted[k]);
+        inner.back() = &shifted[k];
+      }
+    }
+  }
+  for (size_t i = 0; i < program.code.size() && res; i++) {
+    my_type type = (my_type)program.code[i];
+    const Program *value = NULL;
+    if (type == var_param && program.code[i + 1] < table.size())
+      value = table[program.code[i + 1]];
+    if (value != NULL) {
+      res = substitute(*value, {}, result);
+      i++;
+    } else if (type == f_sum || type == f_prod) {
+      const Loop &loop = program.loops[program.code[++i]];
+      Loop copy;
+      copy.body.plugins = loop.body.plugins;
+      copy.from = loop.from;
+      copy.to = loop.to;
+      res = substitute(loop.body, inner, &copy.body) &&
+            result->loops.size() < FUNCTION_MAX_LOOPS;
+      copy.body.depth = code_depth(copy.body);
+      result->code.push_back(type);
+      result->code.push_back(result->loops.size());
+      result->loops.push_back(copy);
+    } else {
+      result->code.push_back(type);
+      if (type == Number) result->constants.push_back(*constant++);
+      if (type == var_column || type == var_param || type == f_plugin)
+        result->code.push_back(program.code[++i]);
+    }
+    if (result->code.size() > FUNCTION_MAX_CODE) res = false;
+  }
+  return res;
+}
+
+// Операция над числами сразу считается теми же calculate_binary и
+// calculate_unary, что и при вычислении, поэтому результат не меняется;
+// библиотечные функции считаются чистыми и тоже сворачиваются, как и
+// циклы, тело которых зависит только от переменной цикла.
+// Если оба операнда - числа, их коды лежат последними перед операцией
+void ModelFunctions::fold_constants(Program *program) {
+  Program folded;
+  std::vector<int> constant;
+  const double *value = program->constants.data();
+  for (size_t i = 0; i < program->code.size(); i++) {
+    my_type type = (my_type)program->code[i];
+    folded.code.push_back(type);
+    if (type == Number) {
+      folded.constants.push_back(*value++);
+      constant.push_back(1);
+    } else if (is_variable(type) || type == var_i) {
+      if (type == var_column || type == var_param)
+        folded.code.push_back(program->code[++i]);
+      constant.push_back(0);
+    } else if (is_binary(type)) {
+      int both = constant[constant.size() - 1] && constant[constant.size() - 2];
+      constant.pop_back();
+      if (both) {
+        double *b = &folded.constants.back();
+        calculate_binary(type, b - 1, b, 1);
+        folded.constants.pop_back();
+        folded.code.resize(folded.code.size() - 2);
+      } else {
+        constant.back() = 0;
+      }
+    } else if (type == f_if) {
+      size_t top = constant.size();
+      int all = constant[top - 1] && constant[top - 2] && constant[top - 3];
+      constant.resize(top - 2);
+      if (all) {
+        double *b = &folded.constants.back();
+        calculate_select(b - 2, b - 1, b, 1);
+        folded.constants.resize(folded.constants.size() - 2);
+        folded.code.resize(folded.code.size() - 3);
+      } else {
+        constant.back() = 0;
+      }
+    } else if (type == f_sum || type == f_prod) {
+      const Loop &loop = program->loops[program->code[++i]];
+      constant.push_back(!depends_on_outer(loop.body));
+      if (constant.back()) {
+        const double *vars[2] = {NULL, NULL};
+        folded.code.back() = Number;
+        folded.constants.push_back(calculate_loop(loop, type, vars, 0));
+      } else {
+        folded.code.push_back(folded.loops.size());
+        folded.loops.push_back(loop);
+      }
+    } else if (type == f_plugin) {
+      unsigned char plugin = program->code[++i];
+      folded.code.push_back(plugin);
+      if (constant.back()) {
+        double *a = &folded.constants.back();
+        *a = plugins[plugin].scalar(*a);
+        folded.code.resize(folded.code.size() - 2);
+      }
+    } else if (constant.back()) {
+      calculate_unary(type, &folded.constants.back(), 1);
+      folded.code.pop_back();
+    }
+  }
+  folded.plugins = program->plugins;
+  folded.depth = program->depth;
+  *program = folded;
+}
+
+}  // namespace s21
@@ -0,0 +1,93 @@
+#ifndef CPP3_SMARTCALC_SRC_MODEL_MODELFUNCTIONS_H
+#define CPP3_SMARTCALC_SRC_MODEL_MODELFUNCTIONS_H
+#include <string>
+#include <vector>
+
+#include "MainModel.h"
+#include "ModelParallel.h"
+
+#define FUNCTION_MAX_PARAMS 16
+#define FUNCTION_MAX_CODE (1 << 16)
+#define FUNCTION_MAX_PLUGINS 256
+#define FUNCTION_MAX_LOOPS 256
+
+namespace s21 {
+// Пользовательские функции вида "f(a,b)=a^2+sin(b)". Тело компилируется
+// один раз при определении, вызовы подставляются в байт-код вызывающего
+// выражения, после чего константные поддеревья сворачиваются в числа.
+// Функции одного аргумента можно загрузить из разделяемой библиотеки:
+// для имени name она экспортирует double name(double) и
+// void name_batch(const double *in, double *out, size_t n).
+// sum(k, a, b, expr) и prod(k, a, b, expr) с целыми a и b считаются
+// пакетным вычислителем по k в нескольких потоках; if(c, a, b), min и max
+// становятся операциями выбора без ветвлений.
+// Библиотеки из load открыты, пока жив объект, и закрываются в деструкторе,
+// поэтому объект не копируется, а программы из compile с функциями
+// библиотек (Plugin хранит их адреса) не должны его пережить. В
+// приложении один объект создаётся в main и передаётся калькулятору и
+// графику, так что загруженные функции видны в обоих
+class ModelFunctions : public MainModel {
+ public:
+  ModelFunctions() = default;
+  ModelFunctions(const ModelFunctions &) = delete;
+  ModelFunctions &operator=(const ModelFunctions &) = delete;
+  ~ModelFunctions();
+
+  std::string define(std::string definition);
+  std::string load(std::string path, std::string names);
+  int compile(std::string expression, Program *program);
+  int calculate(std::string expression, double x, double *result);
+  bool is_call(std::string expression);
+  bool is_definition(std::string text);
+
+  size_t get_count();
+  void clear();
+  void set_parallel(bool value);
+
+ protected:
+  // Комплексный режим: отдельное i - мнимая единица
+  bool imaginary = false;
+  // Сворачивать ли константы в double; не сворачиваются в комплексном
+  // режиме, где вещественное sqrt(-1) дало бы NAN, и при вычислении с
+  // высокой точностью
+  bool fold = true;
+
+ private:
+  typedef struct Function {
+    std::string name;
+    size_t params;
+    Program body;
+  } Function;
+
+  std::vector<Function> functions;
+  std::vector<std::string> plugin_names;
+  std::vector<Plugin> plugins;
+  std::vector<void *> handles;
+  // Большие выражения в calculate делятся на поддеревья для потоков
+  bool parallel = false;
+  ModelParallel subtrees;
+
+  int find(const std::string &name);
+  bool is_used(const std::string &name);
+  size_t match_call(std::string &text, size_t i, int *index);
+  bool match_unit(std::string &text, size_t i);
+  my_type match_builtin(std::string &text, size_t i, size_t *len);
+  int compile_text(std::string text, const std::vector<std::string> &params,
+                   Program *program);
+  bool read_call(const std::string &text, size_t *i,
+                 std::vector<std::string> *args);
+  int compile_loop(my_type type, const std::vector<std::string> &args,
+                   const std::vector<std::string> &params, Program *program);
+  int compile_select(my_type type, const std::vector<std::string> &args,
+                     const std::vector<std::string> &params,
+                     Program *program);
+  bool shift_frame(const Program &program, size_t index, Program *result);
+  bool is_integer(const Program &program);
+  bool depends_on_outer(const Program &program);
+  bool substitute(const Program &program,
+                  const std::vector<const Program *> &table, Program *result);
+  void fold_constants(Program *program);
+};
+}  // namespace s21
+
+#endif  // CPP3_SMARTCALC_SRC_MODEL_MODELFUNCTIONS_H
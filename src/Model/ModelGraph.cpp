@@ -1,5 +1,8 @@
 #include "ModelGraph.h"
 
+#include <deque>
+#include <thread>
+
 namespace s21 {
 
 QString ModelGraph::check(QString text) {
@@ -15,10 +18,8 @@ QString ModelGraph::check(QString text) {
   }
 
   if (!flag_empty && !flag_large) {
-    char *input = text.toUtf8().data();
-    char res[MAX_SIZE_STRING] = "";
-    this->trim_input(input, res);
-    if (this->valid_input(res)) {
+    Program program;
+    if (functions->compile_real(text.toStdString(), &program) == 1) {
       this->allow = true;
     } else {
       res_out = "Incorrect input";
@@ -107,18 +108,381 @@ void ModelGraph::calculate_graph(QString text) {
 
     x.clear();
     y.clear();
-    double X = 0, Y = 0;
-    for (X = min_x; X < max_x; X += h) {
-      char *input_str = text.toUtf8().data();
-      int flag_ok = final_func(input_str, &Y, X);
-      if (flag_ok == 1) {
-        x.push_back(X);
-        y.push_back(Y);
+    std::vector<double> px, py;
+    for (double X = min_x; X < max_x; X += h) px.push_back(X);
+    py.resize(px.size(), NAN);
+    Program program;
+    if (precise &&
+        functions->compile_precise(text.toStdString(), &program) == 1) {
+      functions->calculate_checked(program, px.data(), px.size(), py.data());
+    } else if (functions->compile_real(text.toStdString(), &program) == 1) {
+      // Дорогое выражение заменяется многочленами Чебышёва, построенными
+      // один раз на отрезке; при увеличении масштаба они переиспользуются
+      if (proxy.cost(program) >= CHEBYSHEV_MIN_COST &&
+          (proxy.covers(program, min_x, max_x) ||
+           proxy.build(program, min_x, max_x, CHEBYSHEV_TOLERANCE) == 1)) {
+        proxy.evaluate(px.data(), px.size(), py.data());
+      } else {
+        std::vector<double> buffer(program.depth * BATCH_CHUNK);
+        const double *vars[2] = {px.data(), NULL};
+        for (size_t offset = 0; offset < px.size(); offset += BATCH_CHUNK) {
+          size_t len = px.size() - offset < BATCH_CHUNK ? px.size() - offset
+                                                        : BATCH_CHUNK;
+          calculate_chunk(program, vars, offset, len, buffer.data(),
+                          py.data() + offset);
+        }
+      }
+    }
+    for (size_t k = 0; k < px.size(); k++) {
+      if (!isnan(py[k])) {
+        x.push_back(px[k]);
+        y.push_back(py[k]);
       }
     }
   }
 }
 
+// Точки, где оценка погрешности double не гарантирует PRECISE_TOLERANCE,
+// пересчитываются с высокой точностью
+void ModelGraph::set_precise(bool value) { precise = value; }
+
+QString ModelGraph::check_complex(QString text) {
+  QString res_out = "";
+  Program program;
+  if (text.length() == 0) {
+    res_out = "Empty input";
+  } else if (text.length() > MAX_SIZE_STRING) {
+    res_out = "Too large input";
+  } else if (functions->compile_complex(text.toStdString(), &program) == 1) {
+    this->allow = true;
+  } else {
+    res_out = "Incorrect input";
+  }
+  return res_out;
+}
+
+// Раскраска области: x пробегает прямоугольник осей как комплексное число,
+// в узле сетки DOMAIN_GRID x DOMAIN_GRID пишется номер оттенка по arg(f)
+// из DOMAIN_HUES плюс дробная часть log2|f| для яркости, так что одна
+// шкала QCPColorMap показывает и фазу, и линии уровня модуля
+void ModelGraph::calculate_domain(QString text) {
+  domain.clear();
+  Program program;
+  if (allow && functions->compile_complex(text.toStdString(), &program) == 1) {
+    std::vector<double> re(DOMAIN_GRID * DOMAIN_GRID);
+    std::vector<double> im(re.size());
+    functions->calculate_grid(program, min_x, max_x, min_y, max_y, DOMAIN_GRID,
+                             re.data(), im.data());
+    domain.resize(re.size());
+    for (size_t k = 0; k < re.size(); k++) {
+      double turn = atan2(im[k], re[k]) / (2 * M_PI);
+      if (turn < 0) turn += 1;
+      double hue = floor(turn * DOMAIN_HUES);
+      if (hue >= DOMAIN_HUES) hue = DOMAIN_HUES - 1;
+      double level = log2(hypot(re[k], im[k]));
+      double shade = isfinite(level) ? level - floor(level) : 0;
+      domain[k] = isfinite(re[k] + im[k]) ? hue + shade : NAN;
+    }
+  }
+}
+
+QString ModelGraph::check_implicit(QString text) {
+  QString res_out = "";
+  int flag_empty = 0;
+  int flag_large = 0;
+
+  if (text.length() == 0) {
+    flag_empty = 1;
+  }
+  if (text.length() >= MAX_SIZE_STRING) {
+    flag_large = 1;
+  }
+
+  if (!flag_empty && !flag_large) {
+    Stack *program = NULL;
+    if (compile_implicit(text, &program)) {
+      this->allow = true;
+    } else {
+      this->allow = false;
+      res_out = "Incorrect input";
+    }
+    remove_node(&program);
+  }
+  if (flag_empty) {
+    res_out = "Empty input";
+  }
+  if (flag_large) {
+    res_out = "Too large input";
+  }
+  return res_out;
+}
+
+// Уравнение f(x, y) = 0: y проверяется по тем же правилам, что и x
+bool ModelGraph::compile_implicit(QString text, Stack **program) {
+  bool res = false;
+  QByteArray bytes = text.toUtf8();
+  if (bytes.size() < MAX_SIZE_STRING) {
+    char trimmed[MAX_SIZE_STRING] = "";
+    char masked[MAX_SIZE_STRING] = "";
+    trim_input(bytes.data(), trimmed);
+    for (size_t i = 0; trimmed[i] != '\0'; i++)
+      masked[i] = trimmed[i] == 'y' ? 'x' : trimmed[i];
+    if (valid_input(masked)) {
+      build_program(trimmed, program);
+      res = true;
+    }
+  }
+  return res;
+}
+
+// Кривая строится на сетке IMPLICIT_CELLS x IMPLICIT_CELLS: сначала
+// считается грубая сетка, затем делятся пополам только ячейки, в которых
+// функция меняет знак, и на самых мелких ячейках работает marching squares.
+void ModelGraph::calculate_implicit(QString text) {
+  implicit_x.clear();
+  implicit_y.clear();
+  Stack *program = NULL;
+  if (allow && compile_implicit(text, &program)) {
+    VertexMap values;
+    std::vector<long long> keys;
+    std::vector<int> active, next;
+    int size = 1 << IMPLICIT_DEPTH;
+
+    for (int iy = 0; iy <= IMPLICIT_CELLS; iy += size)
+      for (int ix = 0; ix <= IMPLICIT_CELLS; ix += size)
+        keys.push_back(vertex_key(ix, iy));
+    evaluate_vertices(program, keys, values);
+    for (int iy = 0; iy < IMPLICIT_CELLS; iy += size) {
+      for (int ix = 0; ix < IMPLICIT_CELLS; ix += size) {
+        if (cell_crosses(values, ix, iy, size)) {
+          active.push_back(ix);
+          active.push_back(iy);
+        }
+      }
+    }
+
+    while (size > 1) {
+      int half = size / 2;
+      const int offsets[5][2] = {
+          {half, 0}, {0, half}, {half, half}, {size, half}, {half, size}};
+      keys.clear();
+      for (size_t c = 0; c < active.size(); c += 2) {
+        for (int k = 0; k < 5; k++) {
+          long long key = vertex_key(active[c] + offsets[k][0],
+                                     active[c + 1] + offsets[k][1]);
+          if (values.emplace(key, NAN).second) keys.push_back(key);
+        }
+      }
+      evaluate_vertices(program, keys, values);
+      next.clear();
+      for (size_t c = 0; c < active.size(); c += 2) {
+        for (int k = 0; k < 4; k++) {
+          int ix = active[c] + (k % 2) * half;
+          int iy = active[c + 1] + (k / 2) * half;
+          if (cell_crosses(values, ix, iy, half)) {
+            next.push_back(ix);
+            next.push_back(iy);
+          }
+        }
+      }
+      active.swap(next);
+      size = half;
+    }
+
+    std::vector<long long> segments;
+    EdgeMap points;
+    for (size_t c = 0; c < active.size(); c += 2)
+      march_cell(values, active[c], active[c + 1], segments, points);
+    trace_segments(segments, points);
+  }
+  remove_node(&program);
+}
+
+long long ModelGraph::vertex_key(int ix, int iy) {
+  return (long long)iy * (IMPLICIT_CELLS + 1) + ix;
+}
+
+void ModelGraph::evaluate_vertices(Stack *program,
+                                   const std::vector<long long> &keys,
+                                   VertexMap &values) {
+  double step_x = (double)(max_x - min_x) / IMPLICIT_CELLS;
+  double step_y = (double)(max_y - min_y) / IMPLICIT_CELLS;
+  std::vector<double> px(keys.size()), py(keys.size()), out;
+  for (size_t k = 0; k < keys.size(); k++) {
+    px[k] = min_x + (keys[k] % (IMPLICIT_CELLS + 1)) * step_x;
+    py[k] = min_y + (keys[k] / (IMPLICIT_CELLS + 1)) * step_y;
+  }
+  evaluate_points(program, px, py, out);
+  for (size_t k = 0; k < keys.size(); k++) values[keys[k]] = out[k];
+}
+
+// Точки делятся на непрерывные блоки по числу ядер, каждый блок считается
+// пакетно через calculate_batch
+void ModelGraph::evaluate_points(Stack *program, const std::vector<double> &px,
+                                 const std::vector<double> &py,
+                                 std::vector<double> &out) {
+  size_t n = px.size();
+  size_t threads = std::thread::hardware_concurrency();
+  if (threads == 0) threads = 1;
+  size_t tile = (n + threads - 1) / threads;
+  if (tile < BATCH_CHUNK) tile = BATCH_CHUNK;
+  out.resize(n);
+  std::vector<std::thread> workers;
+  for (size_t begin = 0; begin < n; begin += tile) {
+    size_t len = n - begin < tile ? n - begin : tile;
+    workers.emplace_back([this, program, &px, &py, &out, begin, len]() {
+      set_worker();
+      const double *vars[2] = {px.data() + begin, py.data() + begin};
+      calculate_batch(program, vars, out.data() + begin, len);
+    });
+  }
+  for (size_t k = 0; k < workers.size(); k++) workers[k].join();
+}
+
+bool ModelGraph::cell_crosses(VertexMap &values, int ix, int iy, int size) {
+  double corners[4] = {values[vertex_key(ix, iy)],
+                       values[vertex_key(ix + size, iy)],
+                       values[vertex_key(ix + size, iy + size)],
+                       values[vertex_key(ix, iy + size)]};
+  int positive = 0;
+  bool defined = true;
+  for (int k = 0; k < 4; k++) {
+    if (isnan(corners[k])) defined = false;
+    if (corners[k] > 0) positive++;
+  }
+  return defined && positive > 0 && positive < 4;
+}
+
+// Углы ячейки: 0 (ix, iy), 1 (ix+1, iy), 2 (ix+1, iy+1), 3 (ix, iy+1).
+// Рёбра: 0 = 0-1, 1 = 1-2, 2 = 3-2, 3 = 0-3.
+void ModelGraph::march_cell(VertexMap &values, int ix, int iy,
+                            std::vector<long long> &segments,
+                            EdgeMap &points) {
+  static const int table[16][4] = {
+      {-1, -1, -1, -1}, {3, 0, -1, -1}, {0, 1, -1, -1}, {3, 1, -1, -1},
+      {1, 2, -1, -1},   {0, 1, 2, 3},   {0, 2, -1, -1}, {2, 3, -1, -1},
+      {2, 3, -1, -1},   {0, 2, -1, -1}, {3, 0, 1, 2},   {1, 2, -1, -1},
+      {1, 3, -1, -1},   {0, 1, -1, -1}, {3, 0, -1, -1}, {-1, -1, -1, -1}};
+  static const int edge_ends[4][2] = {{0, 1}, {1, 2}, {3, 2}, {0, 3}};
+  const int corner_x[4] = {ix, ix + 1, ix + 1, ix};
+  const int corner_y[4] = {iy, iy, iy + 1, iy + 1};
+  const long long edge_ids[4] = {
+      2 * vertex_key(ix, iy), 2 * vertex_key(ix + 1, iy) + 1,
+      2 * vertex_key(ix, iy + 1), 2 * vertex_key(ix, iy) + 1};
+  double v[4];
+  int index = 0;
+  for (int k = 0; k < 4; k++) {
+    v[k] = values[vertex_key(corner_x[k], corner_y[k])];
+    if (v[k] > 0) index |= 1 << k;
+  }
+  int edges[4] = {table[index][0], table[index][1], table[index][2],
+                  table[index][3]};
+  // Седловые случаи разрешаются по значению в центре ячейки
+  if ((index == 5 || index == 10) && v[0] + v[1] + v[2] + v[3] <= 0) {
+    for (int k = 0; k < 4; k++) edges[k] = table[15 - index][k];
+  }
+  for (int k = 0; k < 4 && edges[k] != -1; k++) {
+    int a = edge_ends[edges[k]][0];
+    int b = edge_ends[edges[k]][1];
+    double t = v[a] / (v[a] - v[b]);
+    points[edge_ids[edges[k]]] =
+        std::make_pair(corner_x[a] + t * (corner_x[b] - corner_x[a]),
+                       corner_y[a] + t * (corner_y[b] - corner_y[a]));
+    segments.push_back(edge_ids[edges[k]]);
+  }
+}
+
+// Отрезки с общим ребром склеиваются в ломаные, между ломаными ставится NAN
+void ModelGraph::trace_segments(const std::vector<long long> &segments,
+                                EdgeMap &points) {
+  double step_x = (double)(max_x - min_x) / IMPLICIT_CELLS;
+  double step_y = (double)(max_y - min_y) / IMPLICIT_CELLS;
+  size_t count = segments.size() / 2;
+  std::unordered_map<long long, std::pair<long long, long long>> links;
+  for (size_t s = 0; s < count; s++) {
+    for (int end = 0; end < 2; end++) {
+      auto link = links.emplace(segments[2 * s + end],
+                                std::make_pair(-1LL, -1LL));
+      if (link.first->second.first == -1)
+        link.first->second.first = s;
+      else
+        link.first->second.second = s;
+    }
+  }
+  std::vector<char> used(count, 0);
+  for (size_t s = 0; s < count; s++) {
+    if (used[s]) continue;
+    used[s] = 1;
+    std::deque<long long> chain = {segments[2 * s], segments[2 * s + 1]};
+    for (int direction = 0; direction < 2; direction++) {
+      bool extended = true;
+      while (extended) {
+        long long edge = direction ? chain.front() : chain.back();
+        std::pair<long long, long long> link = links[edge];
+        long long other = link.first;
+        if (other == -1 || used[other]) other = link.second;
+        extended = other != -1 && !used[other];
+        if (extended) {
+          used[other] = 1;
+          long long far = segments[2 * other] == edge ? segments[2 * other + 1]
+                                                       : segments[2 * other];
+          if (direction)
+            chain.push_front(far);
+          else
+            chain.push_back(far);
+        }
+      }
+    }
+    for (size_t k = 0; k < chain.size(); k++) {
+      implicit_x.append(min_x + points[chain[k]].first * step_x);
+      implicit_y.append(min_y + points[chain[k]].second * step_y);
+    }
+    implicit_x.append(NAN);
+    implicit_y.append(NAN);
+  }
+}
+
+// Подбор параметров по первым двум столбцам загруженных данных; в ответе
+// найденные значения, число итераций и время
+QString ModelGraph::calculate_fit(QString expression, QString parameters) {
+  fit_x.clear();
+  fit_y.clear();
+  std::string res = "No data";
+  if (data.get_columns() > 1)
+    res = fit.fit(expression.toStdString(), parameters.toStdString(),
+                  data.get_column(0), data.get_column(1), data.get_rows());
+  QString res_out = QString::fromStdString(res);
+  if (res.empty()) {
+    const double *keys = data.get_column(0);
+    double low = INFINITY, high = -INFINITY;
+    for (size_t r = 0; r < data.get_rows(); r++) {
+      if (keys[r] < low) low = keys[r];
+      if (keys[r] > high) high = keys[r];
+    }
+    fit_x.resize(FIT_CURVE_POINTS);
+    fit_y.resize(FIT_CURVE_POINTS);
+    for (int k = 0; k < FIT_CURVE_POINTS; k++)
+      fit_x[k] = low + (high - low) * k / (FIT_CURVE_POINTS - 1);
+    fit.calculate_curve(fit_x.data(), fit_y.data(), FIT_CURVE_POINTS);
+    for (size_t k = 0; k < fit.get_parameters(); k++)
+      res_out = res_out + QString::fromStdString(fit.get_name(k)) + " = " +
+                QString::number(fit.get_value(k), 'g', 8) + "  ";
+    res_out = res_out + "(" + QString::number(fit.get_iterations()) + " it, " +
+              QString::number(fit.get_time(), 'f', 1) + " ms" +
+              (fit.get_converged() ? ")" : ", not converged)");
+  }
+  return res_out;
+}
+
+// Спектр последнего построенного графика (x, y из calculate_graph)
+void ModelGraph::calculate_spectrum() {
+  spectrum.calculate(x.data(), y.data(), x.size());
+  spectrum_x = QVector<double>(spectrum.frequency.begin(),
+                               spectrum.frequency.end());
+  spectrum_y = QVector<double>(spectrum.magnitude.begin(),
+                               spectrum.magnitude.end());
+}
+
 int ModelGraph::get_min_x() { return min_x; }
 
 int ModelGraph::get_max_x() { return max_x; }
@@ -2,17 +2,57 @@
 #define CPP3_SMARTCALC_SRC_MODEL_MODELGRAPH_H
 #include <QString>
 #include <QVector>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "MainModel.h"
+#include "ModelChebyshev.h"
+#include "ModelData.h"
+#include "ModelFit.h"
+#include "ModelPrecise.h"
+#include "ModelSpectrum.h"
+
+#define IMPLICIT_GRID 128
+#define IMPLICIT_DEPTH 4
+#define IMPLICIT_CELLS (IMPLICIT_GRID << IMPLICIT_DEPTH)
+#define FIT_CURVE_POINTS 1000
+#define DOMAIN_GRID 256
+#define DOMAIN_HUES 64
 
 namespace s21 {
+// functions - общий с калькулятором объект функций: определённые там
+// функции и загруженные библиотеки доступны и на графике
 class ModelGraph : public MainModel {
  public:
+  explicit ModelGraph(ModelPrecise *shared) : functions(shared) {}
+
   QString check(QString text);
   QString get_axis(QString previous, QString min_x, QString max_x,
                    QString min_y, QString max_y);
   void calculate_graph(QString text);
   QVector<double> x, y;
+  ModelPrecise *functions;
+  void set_precise(bool value);
+  ModelChebyshev proxy;
+
+  QString check_complex(QString text);
+  void calculate_domain(QString text);
+  QVector<double> domain;
+
+  QString check_implicit(QString text);
+  void calculate_implicit(QString text);
+  QVector<double> implicit_x, implicit_y;
+
+  ModelData data;
+
+  QString calculate_fit(QString expression, QString parameters);
+  QVector<double> fit_x, fit_y;
+  ModelFit fit;
+
+  void calculate_spectrum();
+  QVector<double> spectrum_x, spectrum_y;
+  ModelSpectrum spectrum;
 
   int get_min_x();
   int get_max_x();
@@ -21,6 +61,7 @@ class ModelGraph : public MainModel {
 
  private:
   bool allow = false;
+  bool precise = false;
 
   int min_x = -10;
   int max_x = 10;
@@ -31,6 +72,21 @@ class ModelGraph : public MainModel {
   bool valid_int(QString text);
   bool valid_string(QString input);
   bool valid_cord(int min, int max);
+
+  typedef std::unordered_map<long long, double> VertexMap;
+  typedef std::unordered_map<long long, std::pair<double, double>> EdgeMap;
+
+  bool compile_implicit(QString text, Stack **program);
+  void evaluate_points(Stack *program, const std::vector<double> &px,
+                       const std::vector<double> &py, std::vector<double> &out);
+  void evaluate_vertices(Stack *program, const std::vector<long long> &keys,
+                         VertexMap &values);
+  bool cell_crosses(VertexMap &values, int ix, int iy, int size);
+  void march_cell(VertexMap &values, int ix, int iy,
+                  std::vector<long long> &segments, EdgeMap &points);
+  void trace_segments(const std::vector<long long> &segments,
+                      EdgeMap &points);
+  long long vertex_key(int ix, int iy);
 };
 }  // namespace s21
 #endif  // CPP3_SMARTCALC_SRC_MODEL_MODELGRAPH_H
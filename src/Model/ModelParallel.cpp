@@ -0,0 +1,175 @@
+#include "ModelParallel.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace s21 {
+
+// Возвращает число задач; 0 - выражение дешевле PARALLEL_MIN_COST или
+// не делится, тогда evaluate считает его целиком в одном потоке.
+// Поддерево идёт в задачу, если его цена не больше доли на поток или ни
+// один операнд не дотягивает до PARALLEL_TASK_COST (в том числе у суммы
+// и произведения), иначе просматриваются его операнды
+size_t ModelParallel::build(const Program &program, size_t threads) {
+  this->threads = threads > 0 ? threads : 1;
+  top = program;
+  tasks.clear();
+  slots = count_slots(program);
+
+  // начало инструкции, число констант до неё, первая инструкция
+  // поддерева и его цена
+  std::vector<size_t> pos, constant, start;
+  std::vector<long long> cost;
+  std::vector<size_t> stack;
+  bool valid = program.depth > 0;
+  size_t numbers = 0;
+  for (size_t i = 0; i < program.code.size() && valid; i++) {
+    my_type type = (my_type)program.code[i];
+    size_t k = pos.size();
+    int arity = is_binary(type) ? 2 : (type == f_if ? 3 : 1);
+    if (type == Number || is_variable(type) || type == var_i ||
+        type == f_sum || type == f_prod)
+      arity = 0;
+    long long own = 1;
+    if (type == f_sum || type == f_prod)
+      own = loop_cost(program.loops[program.code[i + 1]]);
+    pos.push_back(i);
+    constant.push_back(numbers);
+    start.push_back(k);
+    cost.push_back(own);
+    valid = stack.size() >= (size_t)arity;
+    for (int a = 0; a < arity && valid; a++) {
+      start[k] = start[stack.back()];
+      cost[k] += cost[stack.back()];
+      stack.pop_back();
+    }
+    stack.push_back(k);
+    if (type == Number) numbers++;
+    if (type == var_column || type == var_param || type == f_plugin ||
+        type == f_sum || type == f_prod)
+      i++;
+  }
+  valid = valid && stack.size() == 1;
+
+  std::vector<size_t> roots;
+  if (valid && this->threads > 1 && cost.back() >= PARALLEL_MIN_COST) {
+    long long size =
+        cost.back() / (this->threads * PARALLEL_TASKS_PER_THREAD);
+    if (size < PARALLEL_TASK_COST) size = PARALLEL_TASK_COST;
+    std::vector<size_t> todo(1, pos.size() - 1);
+    while (!todo.empty()) {
+      size_t k = todo.back();
+      todo.pop_back();
+      my_type type = (my_type)program.code[pos[k]];
+      int arity = is_binary(type) ? 2 : (type == f_if ? 3 : 1);
+      if (start[k] == k) arity = 0;
+      std::vector<size_t> children;
+      bool divisible = false;
+      for (size_t child = k - 1; (int)children.size() < arity;
+           child = start[child] - 1) {
+        children.push_back(child);
+        divisible = divisible || cost[child] >= PARALLEL_TASK_COST;
+      }
+      if (cost[k] < PARALLEL_TASK_COST) {
+        // дешёвое поддерево остаётся в верхней части
+      } else if (cost[k] <= size || !divisible) {
+        if (slots - 2 + roots.size() <= 255) roots.push_back(k);
+      } else {
+        todo.insert(todo.end(), children.begin(), children.end());
+      }
+    }
+  }
+
+  if (roots.size() >= 2) {
+    std::sort(roots.begin(), roots.end());
+    top.code.clear();
+    top.constants.clear();
+    size_t code_from = 0;
+    size_t constant_from = 0;
+    for (size_t t = 0; t < roots.size(); t++) {
+      size_t k = roots[t];
+      size_t first = pos[start[k]];
+      size_t last = k + 1 < pos.size() ? pos[k + 1] : program.code.size();
+      size_t numbers_first = constant[start[k]];
+      size_t numbers_last =
+          k + 1 < pos.size() ? constant[k + 1] : program.constants.size();
+      Program task;
+      task.code.assign(program.code.begin() + first,
+                       program.code.begin() + last);
+      task.constants.assign(program.constants.begin() + numbers_first,
+                            program.constants.begin() + numbers_last);
+      task.plugins = program.plugins;
+      task.loops = program.loops;
+      task.depth = code_depth(task);
+      tasks.push_back(task);
+      top.code.insert(top.code.end(), program.code.begin() + code_from,
+                      program.code.begin() + first);
+      top.code.push_back(var_param);
+      top.code.push_back((unsigned char)(slots - 2 + t));
+      top.constants.insert(top.constants.end(),
+                           program.constants.begin() + constant_from,
+                           program.constants.begin() + numbers_first);
+      code_from = last;
+      constant_from = numbers_last;
+    }
+    top.code.insert(top.code.end(), program.code.begin() + code_from,
+                    program.code.end());
+    top.constants.insert(top.constants.end(),
+                         program.constants.begin() + constant_from,
+                         program.constants.end());
+    top.depth = code_depth(top);
+  }
+  return tasks.size();
+}
+
+// vars - как у calculate_chunk для одной точки; задачи делятся между
+// потоками через одну, верхняя часть считается после них
+double ModelParallel::evaluate(const double *const *vars) {
+  std::vector<double> values(tasks.size());
+  std::vector<const double *> inner(vars, vars + slots);
+  for (size_t t = 0; t < tasks.size(); t++) inner.push_back(&values[t]);
+  size_t workers_count = threads < tasks.size() ? threads : tasks.size();
+  std::vector<std::thread> workers;
+  for (size_t w = 0; w < workers_count; w++)
+    workers.push_back(std::thread([&, w]() {
+      set_worker();
+      for (size_t t = w; t < tasks.size(); t += workers_count) {
+        std::vector<double> buffer(tasks[t].depth);
+        calculate_chunk(tasks[t], vars, 0, 1, buffer.data(), &values[t]);
+      }
+    }));
+  for (size_t w = 0; w < workers.size(); w++) workers[w].join();
+  std::vector<double> buffer(top.depth);
+  double res = NAN;
+  calculate_chunk(top, inner.data(), 0, 1, buffer.data(), &res);
+  return res;
+}
+
+size_t ModelParallel::get_tasks() { return tasks.size(); }
+
+// Число слотов vars, которые читает программа вместе с телами сумм
+size_t ModelParallel::count_slots(const Program &program) {
+  size_t res = 2;
+  for (size_t i = 0; i < program.code.size(); i++) {
+    my_type type = (my_type)program.code[i];
+    if ((type == var_column || type == var_param) &&
+        program.code[i + 1] + 3u > res)
+      res = program.code[i + 1] + 3u;
+    if (type == var_column || type == var_param || type == f_plugin ||
+        type == f_sum || type == f_prod)
+      i++;
+  }
+  for (size_t l = 0; l < program.loops.size(); l++) {
+    size_t inner = count_slots(program.loops[l].body);
+    if (inner > res) res = inner;
+  }
+  return res;
+}
+
+// Цена суммы - число слагаемых на длину тела
+long long ModelParallel::loop_cost(const Loop &loop) {
+  long long terms = loop.to >= loop.from ? loop.to - loop.from + 1 : 0;
+  return terms * (long long)loop.body.code.size();
+}
+
+}  // namespace s21
@@ -0,0 +1,38 @@
+#ifndef CPP3_SMARTCALC_SRC_MODEL_MODELPARALLEL_H
+#define CPP3_SMARTCALC_SRC_MODEL_MODELPARALLEL_H
+#include <stddef.h>
+
+#include <vector>
+
+#include "MainModel.h"
+
+#define PARALLEL_MIN_COST (1 << 15)
+#define PARALLEL_TASK_COST (1 << 12)
+#define PARALLEL_TASKS_PER_THREAD 4
+
+namespace s21 {
+// Параллельное вычисление одного большого выражения. Байт-код разбирается
+// в дерево, непересекающиеся поддеревья ценой от PARALLEL_TASK_COST
+// становятся отдельными программами и считаются в нескольких потоках, а
+// в оставшейся верхней части каждое из них заменяется чтением своего
+// результата (var_param с номером после параметров выражения). Операции
+// и их порядок внутри поддеревьев не меняются, поэтому ответ совпадает с
+// последовательным до бита
+class ModelParallel : public MainModel {
+ public:
+  size_t build(const Program &program, size_t threads);
+  double evaluate(const double *const *vars);
+  size_t get_tasks();
+
+ private:
+  Program top;
+  std::vector<Program> tasks;
+  size_t slots = 2;
+  size_t threads = 1;
+
+  size_t count_slots(const Program &program);
+  long long loop_cost(const Loop &loop);
+};
+}  // namespace s21
+
+#endif  // CPP3_SMARTCALC_SRC_MODEL_MODELPARALLEL_H
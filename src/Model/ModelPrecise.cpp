@@ -0,0 +1,614 @@
+#include "ModelPrecise.h"
+
+namespace s21 {
+
+// Результат как у compile_func: 1 или -2 при ошибке во вводе; кроме x и
+// чисел допускаются только арифметика, функции, сравнения и if/min/max
+int ModelPrecise::compile_precise(std::string expression, Program *program) {
+  bool previous = fold;
+  bool previous_imaginary = imaginary;
+  fold = false;
+  imaginary = false;
+  int res = compile(expression, program);
+  fold = previous;
+  imaginary = previous_imaginary;
+  for (size_t i = 0; i < program->code.size() && res == 1; i++) {
+    my_type type = (my_type)program->code[i];
+    if (type == var_y || type == var_column || type == var_param ||
+        type == f_plugin || type == f_sum || type == f_prod || type == var_i)
+      res = -2;
+  }
+  return res;
+}
+
+// Результат как у final_func, в result - digits значащих цифр. Если
+// оценка погрешности double меньше половины последней цифры с запасом,
+// высокая точность не нужна. Иначе точность удваивается до
+// PRECISE_ROUNDS раз, пока два соседних ответа не совпадут в digits
+// цифрах; выводятся только совпавшие цифры, а если не совпала ни одна
+// (так выглядит сокращение до нуля, например 0.1+0.2-0.3), - 0
+int ModelPrecise::calculate_precise(std::string expression, double x,
+                                    int digits, std::string *result) {
+  int res = -2;
+  Program program;
+  if (digits > 0 && digits <= PRECISE_MAX_DIGITS &&
+      compile_precise(expression, &program) == 1) {
+    res = -1;
+    mp_bitcnt_t bits = digits * 3.3219280948873623 + PRECISE_GUARD_BITS;
+    std::vector<double> buffer(2 * program.depth + 1);
+    double value = NAN;
+    double error = INFINITY;
+    checked_chunk(program, &x, 1, buffer.data(), &value, &error);
+    mpf_class out(0, bits);
+    if (isfinite(value) && error <= 0.05 * pow(10, -digits) * fabs(value)) {
+      out = value;
+      res = 1;
+    } else if (isfinite(x)) {
+      std::vector<std::string> texts = literals(expression, program);
+      mpf_class previous(0, bits);
+      res = calculate_mp(program, x, bits, texts, &out);
+      int same = 0;
+      for (int round = 0; round < PRECISE_ROUNDS && res == 1 && same < digits;
+           round++) {
+        bits *= 2;
+        previous = out;
+        out.set_prec(bits);
+        res = calculate_mp(program, x, bits, texts, &out);
+        same = agreed(out, previous);
+      }
+      if (same < digits) digits = same;
+    }
+    if (res == 1) *result = digits > 0 ? format(out, digits) : "0";
+  }
+  return res;
+}
+
+// Пакетное вычисление в double; точки, где оценка погрешности больше
+// PRECISE_TOLERANCE от значения, пересчитываются с PRECISE_CHECK_DIGITS
+// цифрами и округляются до ближайшего double (mpf_get_d отбрасывает
+// хвост, поэтому он прибавляется отдельно). Возвращает число таких точек
+size_t ModelPrecise::calculate_checked(const Program &program, const double *x,
+                                       size_t n, double *result) {
+  size_t res = 0;
+  mp_bitcnt_t bits =
+      PRECISE_CHECK_DIGITS * 3.3219280948873623 + PRECISE_GUARD_BITS;
+  std::vector<double> buffer((2 * program.depth + 1) * BATCH_CHUNK);
+  double value[BATCH_CHUNK];
+  double error[BATCH_CHUNK];
+  mpf_class out(0, bits);
+  mpf_class rest(0, bits);
+  for (size_t offset = 0; offset < n; offset += BATCH_CHUNK) {
+    size_t len = n - offset < BATCH_CHUNK ? n - offset : BATCH_CHUNK;
+    checked_chunk(program, x + offset, len, buffer.data(), value, error);
+    for (size_t j = 0; j < len; j++) {
+      result[offset + j] = value[j];
+      if (!(error[j] <= PRECISE_TOLERANCE * fabs(value[j]))) {
+        bool valid =
+            isfinite(x[offset + j]) &&
+            calculate_mp(program, x[offset + j], bits, {}, &out) == 1;
+        double head = valid ? out.get_d() : NAN;
+        if (isfinite(head)) {
+          rest = out - head;
+          head += rest.get_d();
+        }
+        result[offset + j] = head;
+        res++;
+      }
+    }
+  }
+  return res;
+}
+
+// Как calculate_chunk, но рядом со значением идёт граница его абсолютной
+// погрешности: погрешности операндов, умноженные на производную, плюс
+// округление результата. В buffer depth слоёв значений, depth слоёв
+// погрешностей и слой под результат операции
+void ModelPrecise::checked_chunk(const Program &program, const double *x,
+                                 size_t len, double *buffer, double *value,
+                                 double *error) {
+  int top = 0;
+  double *errors = buffer + program.depth * len;
+  double *out = errors + program.depth * len;
+  const double *constant = program.constants.data();
+  for (size_t i = 0; i < program.code.size(); i++) {
+    my_type type = (my_type)program.code[i];
+    if (type == Number || type == var_x) {
+      // Числа и x понимаются по десятичной записи, точны только целые
+      double *a = buffer + top * len;
+      double *ea = errors + top * len;
+      double number = type == Number ? *constant++ : 0;
+      for (size_t j = 0; j < len; j++) {
+        a[j] = type == Number ? number : x[j];
+        bool exact = a[j] == floor(a[j]) && fabs(a[j]) < 0x1p53;
+        ea[j] = exact ? 0 : ldexp(fabs(a[j]), -53);
+      }
+      top++;
+    } else if (is_binary(type)) {
+      top--;
+      double *a = buffer + (top - 1) * len;
+      double *ea = errors + (top - 1) * len;
+      memcpy(out, a, len * sizeof(double));
+      calculate_binary(type, out, a + len, len);
+      binary_error(type, a, ea, a + len, ea + len, out, len);
+      memcpy(a, out, len * sizeof(double));
+    } else if (type == f_if) {
+      top -= 2;
+      double *c = buffer + (top - 1) * len;
+      double *ec = errors + (top - 1) * len;
+      // Условие надёжно, если погрешность не может сменить его знак
+      for (size_t j = 0; j < len; j++) {
+        double yes = ec[len + j];
+        double no = ec[2 * len + j];
+        bool sure = (fabs(c[j]) > ec[j]) | ((c[j] == 0) & (ec[j] == 0));
+        ec[j] = sure ? (c[j] != 0 ? yes : no) : INFINITY;
+      }
+      calculate_select(c, c + len, c + 2 * len, len);
+    } else {
+      double *a = buffer + (top - 1) * len;
+      double *ea = errors + (top - 1) * len;
+      memcpy(out, a, len * sizeof(double));
+      calculate_unary(type, out, len);
+      unary_error(type, a, ea, out, len);
+      memcpy(a, out, len * sizeof(double));
+    }
+  }
+  memcpy(value, buffer, len * sizeof(double));
+  memcpy(error, errors, len * sizeof(double));
+}
+
+// Округление u|v| не добавляется, когда операнды и результат - точные
+// целые меньше 2^53: такая операция в double точна
+void ModelPrecise::binary_error(my_type type, const double *a, double *ea,
+                                const double *b, const double *eb,
+                                const double *value, size_t len) {
+  const double u = 0x1p-53;
+  for (size_t j = 0; j < len; j++) {
+    double v = fabs(value[j]);
+    bool exact = (ea[j] == 0) & (eb[j] == 0) & (a[j] == floor(a[j])) &
+                 (b[j] == floor(b[j])) & (v == floor(v)) & (v < 0x1p53);
+    double rounding = exact ? 0 : u * v;
+    double e = INFINITY;
+    if (type == op_plus || type == op_minus) e = ea[j] + eb[j] + rounding;
+    if (type == op_mul)
+      e = fabs(a[j]) * eb[j] + fabs(b[j]) * ea[j] + ea[j] * eb[j] + rounding;
+    if (type == op_div && fabs(b[j]) > eb[j])
+      e = (ea[j] + v * eb[j]) / (fabs(b[j]) - eb[j]) + u * v;
+    if (type == op_mod) {
+      double shift = ea[j] + eb[j] * fabs(a[j] / b[j]);
+      if (v > shift && fabs(b[j]) - v > shift) e = shift;
+    }
+    if (type == op_power) {
+      double from_a = ea[j] == 0 ? 0 : fabs(b[j]) * ea[j] / fabs(a[j]);
+      double from_b = eb[j] == 0 ? 0 : fabs(log(fabs(a[j]))) * eb[j];
+      e = v * (from_a + from_b) + (exact ? 0 : 2 * u * v);
+    }
+    if (type >= op_less && type <= op_not_equal) {
+      double gap = fabs(a[j] - b[j]);
+      if (gap > ea[j] + eb[j] || (gap == 0 && ea[j] + eb[j] == 0)) e = 0;
+    }
+    if (type == f_min || type == f_max) e = ea[j] > eb[j] ? ea[j] : eb[j];
+    ea[j] = e;
+  }
+}
+
+// Погрешность аргумента умножается на модуль производной, функции
+// библиотеки добавляют до двух единиц последнего знака
+void ModelPrecise::unary_error(my_type type, const double *a, double *ea,
+                               const double *value, size_t len) {
+  const double u = 0x1p-53;
+  for (size_t j = 0; j < len; j++) {
+    double v = fabs(value[j]);
+    double e = ea[j];
+    if (type == f_sin || type == f_cos) e = ea[j] + 2 * u * v;
+    if (type == f_tan) e = ea[j] * (1 + v * v) + 2 * u * v;
+    if (type == f_asin || type == f_acos) {
+      double d = 1 - a[j] * a[j];
+      e = ea[j] == 0 ? 0 : (d > 0 ? ea[j] / sqrt(d) : INFINITY);
+      e += 2 * u * v;
+    }
+    if (type == f_atan) e = ea[j] / (1 + a[j] * a[j]) + 2 * u * v;
+    if (type == f_sqrt)
+      e = ea[j] == 0 ? u * v : (v > 0 ? ea[j] / (2 * v) + u * v : INFINITY);
+    if (type == f_ln) e = ea[j] / fabs(a[j]) + 2 * u * v;
+    if (type == f_log) e = ea[j] / (fabs(a[j]) * M_LN10) + 2 * u * v;
+    if (type == f_arg) e = fabs(a[j]) > ea[j] || ea[j] == 0 ? 0 : INFINITY;
+    ea[j] = e;
+  }
+}
+
+// Значение программы с точностью bits бит: 1 или -1, если значение не
+// определено (деление на ноль, корень из отрицательного и т.п.). texts -
+// десятичные записи констант программы по порядку; без них константы
+// восстанавливаются по double
+int ModelPrecise::calculate_mp(const Program &program, double x,
+                               mp_bitcnt_t bits,
+                               const std::vector<std::string> &texts,
+                               mpf_class *result) {
+  bool valid = true;
+  bool own = texts.size() == program.constants.size();
+  std::vector<mpf_class> stack;
+  size_t constant = 0;
+  for (size_t i = 0; i < program.code.size() && valid; i++) {
+    my_type type = (my_type)program.code[i];
+    if (type == Number) {
+      stack.push_back(mpf_class(0, bits));
+      stack.back().set_str(own ? texts[constant]
+                               : shortest(program.constants[constant]),
+                           10);
+      constant++;
+    } else if (type == var_x) {
+      stack.push_back(mpf_class(0, bits));
+      stack.back().set_str(shortest(x), 10);
+    } else if (is_binary(type)) {
+      mpf_class b = stack.back();
+      stack.pop_back();
+      valid = mp_binary(type, stack.back(), b, bits);
+    } else if (type == f_if) {
+      size_t top = stack.size();
+      stack[top - 3] = stack[top - (sgn(stack[top - 3]) != 0 ? 2 : 1)];
+      stack.resize(top - 2);
+    } else if (is_unary(type)) {
+      valid = mp_unary(type, stack.back(), bits);
+    } else {
+      valid = false;
+    }
+  }
+  int res = -1;
+  if (valid && stack.size() == 1) {
+    *result = stack[0];
+    res = 1;
+  }
+  return res;
+}
+
+bool ModelPrecise::mp_binary(my_type type, mpf_class &a, const mpf_class &b,
+                             mp_bitcnt_t bits) {
+  bool res = true;
+  if (type == op_plus) a += b;
+  if (type == op_minus) a -= b;
+  if (type == op_mul) a *= b;
+  if (type == op_div) {
+    if (sgn(b) == 0)
+      res = false;
+    else
+      a /= b;
+  }
+  if (type == op_mod) {
+    mpf_class quotient(0, bits);
+    if (sgn(b) == 0)
+      res = false;
+    else
+      quotient = a / b;
+    a -= trunc(quotient) * b;
+  }
+  if (type == op_power) {
+    // Целая степень - умножениями, положительное основание - через
+    // exp(b * ln(a)), у отрицательного основания степень только целая
+    mpf_class power(0, bits);
+    mpf_class magnitude(abs(b), bits);
+    if (mpf_integer_p(b.get_mpf_t()) && magnitude < 2147483648.0) {
+      mpf_pow_ui(power.get_mpf_t(), a.get_mpf_t(), magnitude.get_ui());
+      if (sgn(b) < 0 && sgn(power) == 0) res = false;
+      if (sgn(b) < 0 && sgn(power) != 0) power = 1 / power;
+    } else if (sgn(a) > 0) {
+      mpf_class logarithm(0, bits + 64);
+      res = mp_log(a, bits + 64, &logarithm);
+      logarithm *= b;
+      if (res) res = mp_exp(logarithm, bits, &power);
+    } else if (sgn(a) < 0 || sgn(b) <= 0) {
+      res = false;
+    }
+    a = power;
+  }
+  if (type == op_less) a = cmp(a, b) < 0;
+  if (type == op_greater) a = cmp(a, b) > 0;
+  if (type == op_less_eq) a = cmp(a, b) <= 0;
+  if (type == op_greater_eq) a = cmp(a, b) >= 0;
+  if (type == op_equal) a = cmp(a, b) == 0;
+  if (type == op_not_equal) a = cmp(a, b) != 0;
+  if (type == f_min && cmp(b, a) < 0) a = b;
+  if (type == f_max && cmp(b, a) > 0) a = b;
+  return res;
+}
+
+bool ModelPrecise::mp_unary(my_type type, mpf_class &a, mp_bitcnt_t bits) {
+  bool res = true;
+  if (type == f_sin) mp_sin(a, bits, false, &a);
+  if (type == f_cos) mp_sin(a, bits, true, &a);
+  if (type == f_tan) {
+    mpf_class cosine(0, bits);
+    mp_sin(a, bits, true, &cosine);
+    mp_sin(a, bits, false, &a);
+    if (sgn(cosine) == 0)
+      res = false;
+    else
+      a /= cosine;
+  }
+  // asin(a) = atan(a / sqrt(1 - a^2)), acos(a) = 2 atan(sqrt((1-a)/(1+a)))
+  if ((type == f_asin || type == f_acos) && cmp(abs(a), 1) > 0) res = false;
+  if (res && type == f_asin) {
+    mpf_class t(0, bits);
+    if (cmp(abs(a), 1) == 0) {
+      a = sgn(a) * mp_pi(bits) / 2;
+    } else {
+      t = a / sqrt((1 - a) * (1 + a));
+      mp_atan(t, bits, &a);
+    }
+  }
+  if (res && type == f_acos) {
+    mpf_class t(0, bits);
+    if (cmp(a, -1) == 0) {
+      a = mp_pi(bits);
+    } else {
+      t = sqrt((1 - a) / (1 + a));
+      mp_atan(t, bits, &a);
+      a *= 2;
+    }
+  }
+  if (type == f_atan) mp_atan(a, bits, &a);
+  if (type == f_sqrt) {
+    if (sgn(a) < 0)
+      res = false;
+    else
+      a = sqrt(a);
+  }
+  if (type == f_ln) res = mp_log(a, bits, &a);
+  if (type == f_log) {
+    mpf_class ten(10, bits);
+    mpf_class ln10(0, bits);
+    res = mp_log(a, bits, &a) && mp_log(ten, bits, &ln10);
+    a /= ln10;
+  }
+  if (type == f_abs) a = abs(a);
+  if (type == f_arg) a = sgn(a) < 0 ? mpf_class(mp_pi(bits), bits) : 0;
+  return res;
+}
+
+// exp(x) = exp(x / 2^k)^(2^k): ряд Тейлора для малого аргумента, затем k
+// возведений в квадрат, на каждое из которых уходит бит точности
+bool ModelPrecise::mp_exp(const mpf_class &x, mp_bitcnt_t bits,
+                          mpf_class *result) {
+  bool res = exponent(x) <= 40;
+  if (res) {
+    long k = exponent(x) + (long)sqrt((double)bits);
+    if (k < 0) k = 0;
+    mp_bitcnt_t prec = bits + k + 16;
+    mpf_class r(x, prec);
+    mpf_class sum(1, prec);
+    mpf_class term(1, prec);
+    mpf_div_2exp(r.get_mpf_t(), r.get_mpf_t(), k);
+    bool done = sgn(r) == 0;
+    for (unsigned long n = 1; !done; n++) {
+      term *= r;
+      term /= n;
+      sum += term;
+      done = sgn(term) == 0 || exponent(term) < -(long)prec;
+    }
+    for (long s = 0; s < k; s++) sum *= sum;
+    *result = sum;
+  }
+  return res;
+}
+
+// ln(x) = e ln2 + 2^(s+1) atanh(z), z = (m - 1) / (m + 1), где m = x / 2^e
+// после s извлечений корня. Аргумент около 1 не сдвигается и корни из
+// него не извлекаются, чтобы не терять точность малого результата
+bool ModelPrecise::mp_log(const mpf_class &x, mp_bitcnt_t bits,
+                          mpf_class *result) {
+  bool res = sgn(x) > 0;
+  if (res) {
+    mp_bitcnt_t prec = bits + 16;
+    long e = exponent(x);
+    if (e == 1) e = 0;
+    mpf_class m(x, prec);
+    if (e > 0) mpf_div_2exp(m.get_mpf_t(), m.get_mpf_t(), e);
+    if (e < 0) mpf_mul_2exp(m.get_mpf_t(), m.get_mpf_t(), -e);
+    int scale = 2;
+    for (int s = 0; s < 4 && cmp(abs(m - 1), 0.01) > 0; s++) {
+      m = sqrt(m);
+      scale *= 2;
+    }
+    mpf_class z(0, prec);
+    mpf_class sum(0, prec);
+    z = (m - 1) / (m + 1);
+    mp_series(z, prec, 1, &sum);
+    sum *= scale;
+    if (e != 0) sum += e * mp_ln2(prec);
+    *result = sum;
+  }
+  return res;
+}
+
+// Аргумент сводится к [-pi, pi] (pi берётся с запасом на величину x),
+// делится на 3^8, ряд Тейлора, затем 8 раз sin(3t) = 3 sin t - 4 sin^3 t
+void ModelPrecise::mp_sin(const mpf_class &x, mp_bitcnt_t bits, bool cosine,
+                          mpf_class *result) {
+  long e = exponent(x);
+  mp_bitcnt_t prec = bits + (e > 0 ? e : 0) + 32;
+  const mpf_class &pi = mp_pi(prec);
+  mpf_class r(x, prec);
+  mpf_class turn(0, prec);
+  turn = floor(r / (2 * pi) + 0.5);
+  r -= turn * 2 * pi;
+  if (cosine) r += pi / 2;
+  mpf_div_ui(r.get_mpf_t(), r.get_mpf_t(), 6561);
+  mpf_class sum(r, prec);
+  mpf_class term(r, prec);
+  mpf_class square(r * r, prec);
+  bool done = sgn(r) == 0;
+  for (unsigned long n = 1; !done; n++) {
+    term *= square;
+    term /= (2 * n) * (2 * n + 1);
+    term = -term;
+    sum += term;
+    done = sgn(term) == 0 || exponent(term) < exponent(r) - (long)prec;
+  }
+  for (int s = 0; s < 8; s++) sum = 3 * sum - 4 * sum * sum * sum;
+  *result = sum;
+}
+
+// atan(x) = pi/2 - atan(1/x) при |x| > 1, затем четыре раза
+// atan(t) = 2 atan(t / (1 + sqrt(1 + t^2))) и ряд
+void ModelPrecise::mp_atan(const mpf_class &x, mp_bitcnt_t bits,
+                           mpf_class *result) {
+  mp_bitcnt_t prec = bits + 16;
+  int sign = sgn(x);
+  mpf_class t(abs(x), prec);
+  mpf_class sum(0, prec);
+  bool invert = cmp(t, 1) > 0;
+  if (invert) t = 1 / t;
+  for (int s = 0; s < 4; s++) t = t / (1 + sqrt(1 + t * t));
+  mp_series(t, prec, -1, &sum);
+  sum *= 16;
+  if (invert) sum = mp_pi(prec) / 2 - sum;
+  if (sign < 0) sum = -sum;
+  *result = sum;
+}
+
+// z + sign z^3/3 + z^5/5 + sign z^7/7 + ...: atan при sign = -1,
+// atanh при sign = 1
+void ModelPrecise::mp_series(const mpf_class &z, mp_bitcnt_t bits, int sign,
+                             mpf_class *result) {
+  mpf_class square(z * z, bits);
+  mpf_class power(z, bits);
+  mpf_class term(0, bits);
+  mpf_class sum(z, bits);
+  if (sign < 0) square = -square;
+  bool done = sgn(z) == 0;
+  for (unsigned long k = 1; !done; k++) {
+    power *= square;
+    term = power / (2 * k + 1);
+    sum += term;
+    done = sgn(term) == 0 || exponent(term) < exponent(z) - (long)bits;
+  }
+  *result = sum;
+}
+
+// pi = 16 atan(1/5) - 4 atan(1/239), считается заново только при большей
+// точности
+const mpf_class &ModelPrecise::mp_pi(mp_bitcnt_t bits) {
+  if (pi_bits < bits) {
+    mpf_class a(1, bits + 16);
+    mpf_class b(1, bits + 16);
+    a /= 5;
+    b /= 239;
+    mp_series(a, bits + 16, -1, &a);
+    mp_series(b, bits + 16, -1, &b);
+    pi_value.set_prec(bits + 16);
+    pi_value = 16 * a - 4 * b;
+    pi_bits = bits;
+  }
+  return pi_value;
+}
+
+// ln2 = 2 atanh(1/3)
+const mpf_class &ModelPrecise::mp_ln2(mp_bitcnt_t bits) {
+  if (ln2_bits < bits) {
+    mpf_class third(1, bits + 16);
+    third /= 3;
+    mp_series(third, bits + 16, 1, &third);
+    ln2_value.set_prec(bits + 16);
+    ln2_value = 2 * third;
+    ln2_bits = bits;
+  }
+  return ln2_value;
+}
+
+// Двоичный порядок: x = d * 2^e, 0.5 <= |d| < 1
+long ModelPrecise::exponent(const mpf_class &x) {
+  long e = 0;
+  mpf_get_d_2exp(&e, x.get_mpf_t());
+  return e;
+}
+
+// Число совпадающих десятичных цифр у a и b, с запасом в одну цифру на
+// перенос при округлении
+int ModelPrecise::agreed(const mpf_class &a, const mpf_class &b) {
+  mpf_class difference(a - b, a.get_prec());
+  int res = PRECISE_MAX_DIGITS;
+  if (sgn(difference) != 0)
+    res = sgn(a) == 0
+              ? 0
+              : (int)((exponent(a) - exponent(difference) - 1) * M_LN2 /
+                      M_LN10) -
+                    1;
+  return res > 0 ? res : 0;
+}
+
+// Десятичные записи чисел из выражения для констант программы: по
+// порядку, если числа в тексте и константы совпадают один к одному, иначе
+// по значению, когда ему соответствует одна запись. Остальные константы
+// (например, из тел функций) восстанавливаются по double
+std::vector<std::string> ModelPrecise::literals(const std::string &expression,
+                                                const Program &program) {
+  std::vector<std::string> found;
+  for (size_t i = 0; i < expression.size(); i++) {
+    bool start = (isdigit(expression[i]) || expression[i] == '.') &&
+                 (i == 0 || !(isalnum(expression[i - 1]) ||
+                              expression[i - 1] == '_' ||
+                              expression[i - 1] == '.'));
+    size_t end = i;
+    while (start && end < expression.size() &&
+           (isdigit(expression[end]) || expression[end] == '.'))
+      end++;
+    if (start) found.push_back(expression.substr(i, end - i));
+  }
+  const std::vector<double> &constants = program.constants;
+  bool ordered = found.size() == constants.size();
+  for (size_t k = 0; k < found.size() && ordered; k++)
+    ordered = atof(found[k].c_str()) == constants[k];
+  std::vector<std::string> res;
+  for (size_t k = 0; k < constants.size(); k++) {
+    std::string text = ordered ? found[k] : "";
+    int matches = 0;
+    for (size_t t = 0; t < found.size() && !ordered; t++)
+      if (atof(found[t].c_str()) == constants[k] && found[t] != text) {
+        matches++;
+        text = found[t];
+      }
+    if (!ordered && matches != 1) text = shortest(constants[k]);
+    res.push_back(text);
+  }
+  return res;
+}
+
+// Самая короткая десятичная запись, которая читается обратно в то же
+// число: 0.1 из ввода считается как 0.1, а не как ближайший к нему double
+std::string ModelPrecise::shortest(double value) {
+  char text[32] = "";
+  bool found = false;
+  for (int digits = 15; digits <= 17 && !found; digits++) {
+    snprintf(text, sizeof(text), "%.*g", digits, value);
+    found = strtod(text, NULL) == value;
+  }
+  return text;
+}
+
+// digits значащих цифр без лишних нулей; очень большие и очень малые
+// числа - с порядком
+std::string ModelPrecise::format(const mpf_class &value, int digits) {
+  mp_exp_t e = 0;
+  std::string text = value.get_str(e, 10, digits);
+  std::string sign = "";
+  if (!text.empty() && text[0] == '-') {
+    sign = "-";
+    text.erase(0, 1);
+  }
+  std::string res_out = "0";
+  if (text.empty()) {
+    res_out = "0";
+  } else if (e > 0 && e <= digits) {
+    if ((size_t)e > text.size()) text.append(e - text.size(), '0');
+    res_out = sign + text.substr(0, e);
+    if ((size_t)e < text.size()) res_out += "." + text.substr(e);
+  } else if (e <= 0 && e > -6) {
+    res_out = sign + "0." + std::string(-e, '0') + text;
+  } else {
+    res_out = sign + text.substr(0, 1);
+    if (text.size() > 1) res_out += "." + text.substr(1);
+    res_out += "e" + std::to_string(e - 1);
+  }
+  return res_out;
+}
+
+}  // namespace s21
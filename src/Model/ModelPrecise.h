@@ -0,0 +1,70 @@
+#ifndef CPP3_SMARTCALC_SRC_MODEL_MODELPRECISE_H
+#define CPP3_SMARTCALC_SRC_MODEL_MODELPRECISE_H
+#include <gmpxx.h>
+
+#include <string>
+#include <vector>
+
+#include "ModelComplex.h"
+
+#define PRECISE_MAX_DIGITS 1000
+#define PRECISE_GUARD_BITS 96
+#define PRECISE_CHECK_DIGITS 40
+#define PRECISE_TOLERANCE 1e-12
+#define PRECISE_ROUNDS 3
+
+namespace s21 {
+// Вычисление с заданным числом значащих цифр (до PRECISE_MAX_DIGITS) на
+// числах GMP; exp, ln, sin, atan и остальные функции считаются рядами
+// здесь же. Сначала выражение считается в double вместе с оценкой
+// погрешности, и только если оценка не гарантирует нужной точности
+// (обычно это вычитание близких чисел), оно пересчитывается с высокой
+// точностью. Числа из ввода берутся по своей десятичной записи, константы
+// не сворачиваются в double; sum, prod и библиотечные функции в этом
+// режиме не принимаются. Ответ высокой точности сверяется с пересчётом
+// при вдвое большей точности, и выводятся только совпавшие цифры
+class ModelPrecise : public ModelComplex {
+ public:
+  int compile_precise(std::string expression, Program *program);
+  int calculate_precise(std::string expression, double x, int digits,
+                        std::string *result);
+  size_t calculate_checked(const Program &program, const double *x, size_t n,
+                           double *result);
+  void checked_chunk(const Program &program, const double *x, size_t len,
+                     double *buffer, double *value, double *error);
+  int calculate_mp(const Program &program, double x, mp_bitcnt_t bits,
+                   const std::vector<std::string> &texts, mpf_class *result);
+
+ private:
+  mpf_class pi_value, ln2_value;
+  mp_bitcnt_t pi_bits = 0;
+  mp_bitcnt_t ln2_bits = 0;
+
+  void binary_error(my_type type, const double *a, double *ea,
+                    const double *b, const double *eb, const double *value,
+                    size_t len);
+  void unary_error(my_type type, const double *a, double *ea,
+                   const double *value, size_t len);
+
+  bool mp_binary(my_type type, mpf_class &a, const mpf_class &b,
+                 mp_bitcnt_t bits);
+  bool mp_unary(my_type type, mpf_class &a, mp_bitcnt_t bits);
+  bool mp_exp(const mpf_class &x, mp_bitcnt_t bits, mpf_class *result);
+  bool mp_log(const mpf_class &x, mp_bitcnt_t bits, mpf_class *result);
+  void mp_sin(const mpf_class &x, mp_bitcnt_t bits, bool cosine,
+              mpf_class *result);
+  void mp_atan(const mpf_class &x, mp_bitcnt_t bits, mpf_class *result);
+  void mp_series(const mpf_class &z, mp_bitcnt_t bits, int sign,
+                 mpf_class *result);
+  const mpf_class &mp_pi(mp_bitcnt_t bits);
+  const mpf_class &mp_ln2(mp_bitcnt_t bits);
+  long exponent(const mpf_class &x);
+  int agreed(const mpf_class &a, const mpf_class &b);
+  std::vector<std::string> literals(const std::string &expression,
+                                    const Program &program);
+  std::string shortest(double value);
+  std::string format(const mpf_class &value, int digits);
+};
+}  // namespace s21
+
+#endif  // CPP3_SMARTCALC_SRC_MODEL_MODELPRECISE_H
@@ -0,0 +1,102 @@
+#include "ModelSpectrum.h"
+
+namespace s21 {
+
+// Амплитудный спектр графика: точки (x, y) пересчитываются на равномерную
+// сетку из 2^k отсчётов, затем считается БПФ
+void ModelSpectrum::calculate(const double *x, const double *y, size_t n) {
+  frequency.clear();
+  magnitude.clear();
+  double step = 0;
+  size_t size = resample(x, y, n, &step);
+  if (size > 0) {
+    fft(re.data(), im.data(), size);
+    for (size_t k = 0; k <= size / 2; k++) {
+      double amplitude = sqrt(re[k] * re[k] + im[k] * im[k]) / size;
+      frequency.push_back(k / (size * step));
+      magnitude.push_back(k == 0 || k == size / 2 ? amplitude : 2 * amplitude);
+    }
+  }
+}
+
+// Линейная интерполяция на сетку x0 + k * step, k < size;
+// size - степень двойки не меньше n
+size_t ModelSpectrum::resample(const double *x, const double *y, size_t n,
+                               double *step) {
+  size_t size = 0;
+  if (n >= 2 && x[n - 1] > x[0]) {
+    size = 2;
+    while (size < n && size < SPECTRUM_MAX_SIZE) size <<= 1;
+    *step = (x[n - 1] - x[0]) / size;
+    re.assign(size, 0);
+    im.assign(size, 0);
+    size_t j = 0;
+    for (size_t k = 0; k < size; k++) {
+      double t = x[0] + k * *step;
+      while (j + 2 < n && x[j + 1] <= t) j++;
+      double w = x[j + 1] > x[j] ? (t - x[j]) / (x[j + 1] - x[j]) : 0;
+      re[k] = y[j] + w * (y[j + 1] - y[j]);
+    }
+  }
+  return size;
+}
+
+// Поворачивающие множители этапа с половиной длины m лежат подряд в
+// [m - 1, 2m - 1) и не зависят от размера преобразования, поэтому одна
+// таблица обслуживает все размеры до самого большого
+void ModelSpectrum::prepare_twiddles(size_t n) {
+  if (twiddle_re.size() < n - 1) {
+    twiddle_re.resize(n - 1);
+    twiddle_im.resize(n - 1);
+    for (size_t m = 1; m < n; m <<= 1) {
+      for (size_t j = 0; j < m; j++) {
+        twiddle_re[m - 1 + j] = cos(-M_PI * j / m);
+        twiddle_im[m - 1 + j] = sin(-M_PI * j / m);
+      }
+    }
+  }
+}
+
+void ModelSpectrum::bit_reverse(double *re, double *im, size_t n) {
+  for (size_t i = 1, j = 0; i < n; i++) {
+    size_t bit = n >> 1;
+    for (; j & bit; bit >>= 1) j ^= bit;
+    j ^= bit;
+    if (i < j) {
+      double tmp = re[i];
+      re[i] = re[j];
+      re[j] = tmp;
+      tmp = im[i];
+      im[i] = im[j];
+      im[j] = tmp;
+    }
+  }
+}
+
+// Итеративное БПФ по основанию 2 на раздельных массивах re/im; внутренний
+// цикл идёт по подряд лежащим данным и множителям и векторизуется
+// компилятором
+void ModelSpectrum::fft(double *re, double *im, size_t n) {
+  prepare_twiddles(n);
+  bit_reverse(re, im, n);
+  for (size_t m = 1; m < n; m <<= 1) {
+    const double *wr = twiddle_re.data() + m - 1;
+    const double *wi = twiddle_im.data() + m - 1;
+    for (size_t k = 0; k < n; k += 2 * m) {
+      double *ar = re + k;
+      double *ai = im + k;
+      double *br = re + k + m;
+      double *bi = im + k + m;
+      for (size_t j = 0; j < m; j++) {
+        double tr = br[j] * wr[j] - bi[j] * wi[j];
+        double ti = br[j] * wi[j] + bi[j] * wr[j];
+        br[j] = ar[j] - tr;
+        bi[j] = ai[j] - ti;
+        ar[j] += tr;
+        ai[j] += ti;
+      }
+    }
+  }
+}
+
+}  // namespace s21
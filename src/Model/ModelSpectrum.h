@@ -0,0 +1,28 @@
+#ifndef CPP3_SMARTCALC_SRC_MODEL_MODELSPECTRUM_H
+#define CPP3_SMARTCALC_SRC_MODEL_MODELSPECTRUM_H
+#include <math.h>
+#include <stddef.h>
+
+#include <vector>
+
+#define SPECTRUM_MAX_SIZE (1 << 20)
+
+namespace s21 {
+class ModelSpectrum {
+ public:
+  void calculate(const double *x, const double *y, size_t n);
+  void fft(double *re, double *im, size_t n);
+
+  std::vector<double> frequency, magnitude;
+
+ private:
+  std::vector<double> twiddle_re, twiddle_im;
+  std::vector<double> re, im;
+
+  size_t resample(const double *x, const double *y, size_t n, double *step);
+  void prepare_twiddles(size_t n);
+  void bit_reverse(double *re, double *im, size_t n);
+};
+}  // namespace s21
+
+#endif  // CPP3_SMARTCALC_SRC_MODEL_MODELSPECTRUM_H
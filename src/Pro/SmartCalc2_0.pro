@@ -4,6 +4,8 @@ greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 CONFIG += c++17
 
+unix: LIBS += -ldl -lgmpxx -lgmp
+
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
@@ -13,11 +15,22 @@ SOURCES += \
     ../Controller/ControllerCredit.cpp \
     ../Controller/ControllerGraph.cpp \
     ../Model/MainModel.cpp \
+    ../Model/ModelCache.cpp \
     ../Model/ModelCalculator.cpp \
+    ../Model/ModelCalendar.cpp \
+    ../Model/ModelChebyshev.cpp \
+    ../Model/ModelComplex.cpp \
     ../Model/ModelCredit.cpp \
+    ../Model/ModelData.cpp \
+    ../Model/ModelFit.cpp \
+    ../Model/ModelFunctions.cpp \
+    ../Model/ModelParallel.cpp \
+    ../Model/ModelPrecise.cpp \
+    ../Model/ModelSpectrum.cpp \
     ../Model/ModelGraph.cpp \
     ../View/credit.cpp \
     ../View/graph.cpp \
+    ../View/schedule.cpp \
     ../View/main.cpp \
     ../View/mainwindow.cpp \
     ../View/qcustomplot_1.cpp \
@@ -27,12 +40,23 @@ HEADERS += \
     ../Controller/ControllerCredit.h \
     ../Controller/ControllerGraph.h \
     ../Model/MainModel.h \
+    ../Model/ModelCache.h \
     ../Controller/ControllerCalculator.h \
     ../Model/ModelCalculator.h \
+    ../Model/ModelCalendar.h \
+    ../Model/ModelChebyshev.h \
+    ../Model/ModelComplex.h \
     ../Model/ModelCredit.h \
+    ../Model/ModelData.h \
+    ../Model/ModelFit.h \
+    ../Model/ModelFunctions.h \
+    ../Model/ModelParallel.h \
+    ../Model/ModelPrecise.h \
+    ../Model/ModelSpectrum.h \
     ../Model/ModelGraph.h \
     ../View/credit.h \
     ../View/graph.h \
+    ../View/schedule.h \
     ../View/mainwindow.h \
     ../View/qcustomplot.h
 
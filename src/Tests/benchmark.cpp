@@ -0,0 +1,77 @@
+// Память и скорость скомпилированных программ: список узлов Stack против
+// упакованного байт-кода Program на выражениях разной длины; время
+// подбора параметров по BENCHMARK_POINTS точкам
+#include <malloc.h>
+
+#include <chrono>
+#include <vector>
+
+#include <thread>
+
+#include "../Model/MainModel.h"
+#include "../Model/ModelFit.h"
+
+#define BENCHMARK_POINTS (1 << 20)
+
+// Программа в обратной польской записи: x 1 + 2 * 3 - ... с n токенами
+static s21::MainModel::Stack *build_list(s21::MainModel &model, size_t n) {
+  const s21::MainModel::my_type ops[] = {
+      s21::MainModel::op_plus, s21::MainModel::op_mul,
+      s21::MainModel::op_minus, s21::MainModel::op_div};
+  s21::MainModel::Stack *inverse = NULL, *program = NULL;
+  model.push_node(&inverse, 0, 0, s21::MainModel::var_x);
+  for (size_t k = 1; k + 1 < n; k += 2) {
+    model.push_node(&inverse, 1 + k % 7, 0, s21::MainModel::Number);
+    model.push_node(&inverse, 0, 0, ops[k / 2 % 4]);
+  }
+  model.inverse_stack(&inverse, &program);
+  return program;
+}
+
+// Узел плюс служебный заголовок блока malloc
+static size_t list_bytes(s21::MainModel::Stack *program) {
+  size_t res = 0;
+  for (s21::MainModel::Stack *node = program; node; node = node->next)
+    res += malloc_usable_size(node) + sizeof(size_t);
+  return res;
+}
+
+int main() {
+  s21::MainModel model;
+  std::vector<double> x(BENCHMARK_POINTS), y(BENCHMARK_POINTS);
+  for (size_t j = 0; j < x.size(); j++) x[j] = j * 1e-6;
+  const double *vars[2] = {x.data(), NULL};
+  printf("%10s %12s %12s %8s %12s %12s\n", "tokens", "list, B", "packed, B",
+         "ratio", "pack, us", "eval, ms");
+  for (size_t n = 15; n <= 150000; n *= 10) {
+    s21::MainModel::Stack *program = build_list(model, n);
+    s21::MainModel::Program packed;
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    model.pack_program(program, &packed);
+    double pack = std::chrono::duration<double, std::micro>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+    size_t points = BENCHMARK_POINTS / (n / 15);
+    start = std::chrono::steady_clock::now();
+    model.calculate_batch(program, vars, y.data(), points);
+    double eval = std::chrono::duration<double, std::milli>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+    size_t list = list_bytes(program);
+    size_t bytes =
+        packed.code.size() + packed.constants.size() * sizeof(double);
+    printf("%10zu %12zu %12zu %8.1f %12.1f %12.2f\n", n, list, bytes,
+           (double)list / bytes, pack, eval);
+    model.remove_node(&program);
+  }
+  s21::ModelFit fit;
+  for (size_t j = 0; j < x.size(); j++)
+    y[j] = 2.5 * sin(1.3 * x[j] * 20) + 0.7 + 0.01 * sin(977.0 * j);
+  std::string error = fit.fit("a*sin(b*x)+c", "a=2, b=24, c", x.data(),
+                              y.data(), x.size());
+  printf("\nfit %zu points, %u threads: %.0f ms, %d iterations %s\n",
+         x.size(), std::thread::hardware_concurrency(), fit.get_time(),
+         fit.get_iterations(), error.empty() ? "" : error.c_str());
+  return 0;
+}
@@ -0,0 +1,18 @@
+#include <math.h>
+#include <stddef.h>
+
+// Пример библиотеки функций для ModelFunctions::load:
+// g++ -shared -fPIC plugin.cpp -o plugin.so
+extern "C" {
+double phi(double x) { return 0.5 * erfc(-x / sqrt(2)); }
+
+void phi_batch(const double *in, double *out, size_t n) {
+  for (size_t j = 0; j < n; j++) out[j] = 0.5 * erfc(-in[j] / sqrt(2));
+}
+
+double sinc(double x) { return x != 0 ? sin(x) / x : 1; }
+
+void sinc_batch(const double *in, double *out, size_t n) {
+  for (size_t j = 0; j < n; j++) out[j] = in[j] != 0 ? sin(in[j]) / in[j] : 1;
+}
+}
@@ -1,7 +1,20 @@
 #include <gtest/gtest.h>
 
+#include <complex>
+#include <thread>
+
 #include "../Model/MainModel.h"
+#include "../Model/ModelCache.h"
+#include "../Model/ModelCalendar.h"
+#include "../Model/ModelChebyshev.h"
+#include "../Model/ModelComplex.h"
 #include "../Model/ModelCredit.h"
+#include "../Model/ModelData.h"
+#include "../Model/ModelFit.h"
+#include "../Model/ModelFunctions.h"
+#include "../Model/ModelParallel.h"
+#include "../Model/ModelPrecise.h"
+#include "../Model/ModelSpectrum.h"
 
 TEST(Model_calculator, Test1) {
   s21::MainModel model;
@@ -131,6 +144,587 @@ TEST(Model_calculator, Test16) {
   EXPECT_EQ(-1, model.final_func(input, &res, 0));
 }
 
+TEST(Model_calculator, Test17) {
+  s21::MainModel model;
+  s21::MainModel::Stack *program = NULL;
+  char input[] = "sin(x)*ln(x)-x^2";
+  double res = 0, expected = 0;
+  EXPECT_EQ(1, model.compile_func(input, &program));
+  for (double x = 0.5; x < 10; x += 0.75) {
+    model.final_func(input, &expected, x);
+    EXPECT_EQ(1, model.calculate_program(program, x, 0, &res));
+    EXPECT_DOUBLE_EQ(expected, res);
+  }
+  model.remove_node(&program);
+}
+
+TEST(Model_calculator, Test18) {
+  s21::MainModel model;
+  s21::MainModel::Stack *program = NULL;
+  char input[] = "sqrt(x)+1/(x-3)";
+  double xs[1000], ys[1000], out[1000];
+  for (int k = 0; k < 1000; k++) xs[k] = k * 0.01 - 2;
+  const double *vars[2] = {xs, ys};
+  model.compile_func(input, &program);
+  model.calculate_batch(program, vars, out, 1000);
+  for (int k = 0; k < 1000; k++) {
+    double expected = 0;
+    if (model.final_func(input, &expected, xs[k]) == 1)
+      EXPECT_DOUBLE_EQ(expected, out[k]);
+    else
+      EXPECT_TRUE(isnan(out[k]));
+  }
+  model.remove_node(&program);
+}
+
+TEST(Model_calculator, Test19) {
+  s21::MainModel model;
+  s21::MainModel::Stack *program = NULL;
+  char input[] = "x^2+y";
+  double res = 0;
+  EXPECT_EQ(-2, model.compile_func(input, &program));
+  model.build_program(input, &program);
+  EXPECT_EQ(1, model.calculate_program(program, 3, -1, &res));
+  EXPECT_DOUBLE_EQ(8, res);
+  model.remove_node(&program);
+}
+
+TEST(Model_calculator, Test20) {
+  s21::MainModel model;
+  s21::MainModel::Stack *program = NULL;
+  s21::MainModel::Program packed;
+  char input[] = "2.5*a-sin(x)^3";
+  model.build_named_program(input, &program, {"a"}, s21::MainModel::var_param);
+  model.pack_program(program, &packed);
+  EXPECT_EQ(packed.depth, 3);
+  EXPECT_EQ(packed.code.size(), 9u);
+  ASSERT_EQ(packed.constants.size(), 2u);
+  EXPECT_DOUBLE_EQ(packed.constants[0], 2.5);
+  EXPECT_DOUBLE_EQ(packed.constants[1], 3);
+  double xs[] = {0, 1, 2}, a = 4, buffer[9], out[3];
+  const double *vars[3] = {xs, NULL, &a};
+  model.calculate_chunk(packed, vars, 0, 3, buffer, out);
+  for (int k = 0; k < 3; k++)
+    EXPECT_DOUBLE_EQ(out[k], 2.5 * 4 - pow(sin(xs[k]), 3));
+  model.remove_node(&program);
+  model.build_program((char *)"1+", &program);
+  model.pack_program(program, &packed);
+  EXPECT_EQ(packed.depth, -1);
+  EXPECT_TRUE(packed.code.empty());
+  model.remove_node(&program);
+}
+
+TEST(Model_calculator, Test21) {
+  s21::MainModel model;
+  double result = 0;
+  EXPECT_EQ(model.final_func((char *)"2+(x>1)*3", &result, 2), 1);
+  EXPECT_DOUBLE_EQ(result, 5);
+  EXPECT_EQ(model.final_func((char *)"x<=1+1", &result, 2), 1);
+  EXPECT_DOUBLE_EQ(result, 1);
+  EXPECT_EQ(model.final_func((char *)"abs(x-5)>=4", &result, 2), 1);
+  EXPECT_DOUBLE_EQ(result, 0);
+  EXPECT_EQ(model.final_func((char *)"-x==(-2)", &result, 2), 1);
+  EXPECT_DOUBLE_EQ(result, 1);
+  EXPECT_EQ(model.final_func((char *)"x!=2", &result, 2), 1);
+  EXPECT_DOUBLE_EQ(result, 0);
+  EXPECT_EQ(model.final_func((char *)"x<", &result, 2), -2);
+  EXPECT_EQ(model.final_func((char *)"<x", &result, 2), -2);
+  EXPECT_EQ(model.final_func((char *)"x+<1", &result, 2), -2);
+  EXPECT_EQ(model.final_func((char *)"x=1", &result, 2), -2);
+  EXPECT_EQ(model.final_func((char *)"2abs(x)", &result, 2), -2);
+  s21::MainModel::Stack *program = NULL;
+  EXPECT_EQ(model.compile_func((char *)"abs(x)<2", &program), 1);
+  double out = 0;
+  EXPECT_EQ(model.calculate_program(program, -3, 0, &out), 1);
+  EXPECT_DOUBLE_EQ(out, 0);
+  model.remove_node(&program);
+}
+
+TEST(Model_cache, Test1) {
+  std::string path = testing::TempDir() + "smartcalc_cache.bin";
+  remove(path.c_str());
+  s21::MainModel::Program first, second, cached;
+  {
+    s21::ModelCache cache;
+    EXPECT_EQ(cache.open(path), "");
+    EXPECT_EQ(cache.compile("sin(x) * 2.5 - x^3", &first), 1);
+    EXPECT_EQ(cache.compile("ln(x)+0.125", &second), 1);
+    EXPECT_EQ(cache.compile("sin(x)*2.5-x^3", &cached), 1);
+    EXPECT_EQ(cache.compile("1+", &cached), -2);
+    EXPECT_EQ(cache.get_misses(), 2u);
+    EXPECT_EQ(cache.get_hits(), 1u);
+    EXPECT_EQ(cache.save(), "");
+    EXPECT_EQ(cache.get_entries(), 2u);
+  }
+  s21::ModelCache cache;
+  EXPECT_EQ(cache.open(path), "");
+  EXPECT_EQ(cache.compile("  ln(x) + 0.125", &cached), 1);
+  EXPECT_EQ(cached.code, second.code);
+  EXPECT_EQ(cached.constants, second.constants);
+  EXPECT_EQ(cache.compile("sin(x)*2.5-x^3", &cached), 1);
+  EXPECT_EQ(cached.code, first.code);
+  EXPECT_EQ(cached.depth, first.depth);
+  EXPECT_EQ(cache.get_hits(), 2u);
+  EXPECT_EQ(cache.get_misses(), 0u);
+  double x = 0.7, buffer[8], out = 0;
+  const double *vars[2] = {&x, NULL};
+  cache.calculate_chunk(cached, vars, 0, 1, buffer, &out);
+  EXPECT_DOUBLE_EQ(out, sin(0.7) * 2.5 - pow(0.7, 3));
+  FILE *file = fopen(path.c_str(), "r+b");
+  fseek(file, -3, SEEK_END);
+  fputc('!', file);
+  fclose(file);
+  EXPECT_EQ(cache.open(path), "Incorrect cache");
+  EXPECT_EQ(cache.compile("ln(x)+0.125", &cached), 1);
+  EXPECT_EQ(cache.get_misses(), 1u);
+  std::vector<std::thread> writers;
+  for (int k = 0; k < 4; k++)
+    writers.emplace_back([&path, k]() {
+      s21::ModelCache own;
+      s21::MainModel::Program program;
+      own.open(path);
+      own.compile("x+" + std::to_string(k), &program);
+      EXPECT_EQ(own.save(), "");
+    });
+  for (size_t k = 0; k < writers.size(); k++) writers[k].join();
+  EXPECT_EQ(cache.open(path), "");
+  EXPECT_GE(cache.get_entries(), 1u);
+  EXPECT_FALSE(std::is_copy_constructible<s21::ModelCache>::value);
+  remove(path.c_str());
+}
+
+TEST(Model_functions, Test1) {
+  s21::ModelFunctions model;
+  EXPECT_EQ(model.define("f(a, b) = a^2 + sin(b)"), "");
+  EXPECT_EQ(model.define("g(t)=f(t,t)-f(f(1,0),2)"), "");
+  EXPECT_EQ(model.get_count(), 2u);
+  double result = 0;
+  EXPECT_EQ(model.calculate("f(x,2)*3", 1.5, &result), 1);
+  EXPECT_DOUBLE_EQ(result, (1.5 * 1.5 + sin(2)) * 3);
+  EXPECT_EQ(model.calculate("g(x/2)", 1, &result), 1);
+  EXPECT_DOUBLE_EQ(result, 0.25 + sin(0.5) - (pow(1 + sin(0), 2) + sin(2)));
+  s21::MainModel::Program inlined, written;
+  EXPECT_EQ(model.compile("f(x,1)", &inlined), 1);
+  EXPECT_EQ(model.compile("x^2+sin(1)", &written), 1);
+  EXPECT_EQ(inlined.code, written.code);
+  EXPECT_EQ(inlined.constants, written.constants);
+  EXPECT_EQ(model.compile("g(2)+x", &inlined), 1);
+  EXPECT_EQ(inlined.code.size(), 3u);
+  ASSERT_EQ(inlined.constants.size(), 1u);
+  EXPECT_DOUBLE_EQ(inlined.constants[0], 4 + sin(2) - (1 + sin(2)));
+  EXPECT_EQ(model.define("h(n)=ln(n)"), "");
+  EXPECT_EQ(model.define("q(t, s, d)=sqrt(t)+cos(s)-(d)mod(3)"), "");
+  EXPECT_EQ(model.calculate("h(x)+q(4,0,x)", 5, &result), 1);
+  EXPECT_DOUBLE_EQ(result, log(5) + 2 + 1 - 2);
+}
+
+TEST(Model_functions, Test2) {
+  s21::ModelFunctions model;
+  double result = 0;
+  EXPECT_EQ(model.define("f(a,a)=a"), "Incorrect definition");
+  EXPECT_EQ(model.define("sin(a)=a"), "Incorrect definition");
+  EXPECT_EQ(model.define("f(a=a"), "Incorrect definition");
+  EXPECT_EQ(model.define("f(a)=a+"), "Incorrect input");
+  EXPECT_EQ(model.define("f(a)=b"), "Incorrect input");
+  EXPECT_EQ(model.define("f(a)=sqrt(a)"), "");
+  EXPECT_EQ(model.define("c()=2"), "");
+  EXPECT_TRUE(model.is_definition("f(a)=sqrt(a)"));
+  EXPECT_TRUE(model.is_definition(" g (a, b) = a<=b"));
+  EXPECT_TRUE(model.is_definition("f(a=a"));
+  const char *comparisons[] = {"x<=1", "x>=0", "2==2", "x!=1", "f(x)==2"};
+  for (int k = 0; k < 5; k++) {
+    EXPECT_FALSE(model.is_definition(comparisons[k]));
+    EXPECT_EQ(model.calculate(comparisons[k], 0, &result), 1);
+    EXPECT_DOUBLE_EQ(result, k < 4);
+  }
+  EXPECT_EQ(model.calculate("if(x^(-1)>0-x^(-1),1,2)", 0, &result), 1);
+  EXPECT_DOUBLE_EQ(result, 1);
+  EXPECT_EQ(model.calculate("(x^(-1)==0-x^(-1))+(x^(-1)!=0-x^(-1))", 0,
+                            &result),
+            1);
+  EXPECT_DOUBLE_EQ(result, 1);
+  EXPECT_EQ(model.calculate("if(0/x>1,1,2)", 0, &result), -1);
+  EXPECT_FALSE(model.is_definition("=2"));
+  EXPECT_FALSE(model.is_definition("1(x)=2"));
+  EXPECT_TRUE(model.is_call("1+f(2)"));
+  EXPECT_FALSE(model.is_call("1+ff(2)"));
+  EXPECT_EQ(model.calculate("f(1,2)", 0, &result), -2);
+  EXPECT_EQ(model.calculate("f(1", 0, &result), -2);
+  EXPECT_EQ(model.calculate("f()", 0, &result), -2);
+  EXPECT_EQ(model.calculate("f(1)+#0", 0, &result), -2);
+  EXPECT_EQ(model.calculate("f(x)", -1, &result), -1);
+  EXPECT_EQ(model.calculate("f(c()*8)", 0, &result), 1);
+  EXPECT_DOUBLE_EQ(result, 4);
+  EXPECT_EQ(model.define("f(a)=-a"), "");
+  EXPECT_EQ(model.get_count(), 2u);
+  EXPECT_EQ(model.calculate("f(x)", -1, &result), 1);
+  EXPECT_DOUBLE_EQ(result, 1);
+  model.clear();
+  EXPECT_EQ(model.calculate("f(1)", 0, &result), -2);
+}
+
+TEST(Model_functions, Test3) {
+  s21::ModelFunctions model;
+  double result = 0;
+  EXPECT_EQ(model.load("./missing.so", "phi"), "Cannot open library");
+  EXPECT_EQ(model.load("./plugin.so", "phi, erf_x"), "No function erf_x");
+  EXPECT_EQ(model.load("./plugin.so", "phi, sin"), "Incorrect name");
+  EXPECT_EQ(model.load("./plugin.so", "phi, sinc"), "");
+  EXPECT_EQ(model.load("./plugin.so", "phi"), "Incorrect name");
+  EXPECT_EQ(model.define("phi(a)=a"), "Incorrect definition");
+  EXPECT_EQ(model.define("g(a)=phi(a)+phi(-a)"), "");
+  EXPECT_EQ(model.calculate("phi(1,2)", 0, &result), -2);
+  EXPECT_EQ(model.calculate("phi(0)", 0, &result), 1);
+  EXPECT_DOUBLE_EQ(result, 0.5);
+  EXPECT_EQ(model.calculate("g(x)", 1.3, &result), 1);
+  EXPECT_DOUBLE_EQ(result, 1);
+  s21::MainModel::Program program;
+  EXPECT_EQ(model.compile("phi(x)*2+sinc(1)", &program), 1);
+  EXPECT_EQ(program.code.size(), 7u);
+  ASSERT_EQ(program.constants.size(), 2u);
+  EXPECT_DOUBLE_EQ(program.constants[1], sin(1));
+  std::vector<double> x(1000), y(1000), buffer(program.depth * 1000);
+  for (size_t j = 0; j < x.size(); j++) x[j] = j * 0.01 - 5;
+  const double *vars[2] = {x.data(), NULL};
+  model.calculate_chunk(program, vars, 0, x.size(), buffer.data(), y.data());
+  for (size_t j = 0; j < x.size(); j++)
+    EXPECT_DOUBLE_EQ(y[j], erfc(-x[j] / sqrt(2)) + sin(1));
+  EXPECT_FALSE(std::is_copy_constructible<s21::ModelFunctions>::value);
+  EXPECT_FALSE(std::is_copy_assignable<s21::ModelPrecise>::value);
+}
+
+TEST(Model_functions, Test4) {
+  s21::ModelFunctions model;
+  double result = 0;
+  s21::MainModel::Program program;
+  EXPECT_EQ(model.compile("sum(k, 1, 100, k)", &program), 1);
+  ASSERT_EQ(program.code.size(), 1u);
+  EXPECT_DOUBLE_EQ(program.constants[0], 5050);
+  EXPECT_EQ(model.calculate("prod(k,1,20,k)", 0, &result), 1);
+  EXPECT_EQ(result, 2432902008176640000.0);
+  double n = 1e7;
+  EXPECT_EQ(model.calculate("sum(k,1,10^7,1/k^2)", 0, &result), 1);
+  EXPECT_NEAR(result, M_PI * M_PI / 6 - 1 / n + 1 / (2 * n * n), 1e-16);
+  double again = 0;
+  model.calculate("sum(k,1,10^7,1/k^2)", 0, &again);
+  EXPECT_EQ(result, again);
+  again = 0;
+  std::thread([&]() {
+    s21::MainModel::set_worker();
+    model.calculate("sum(k,1,10^7,1/k^2)", 0, &again);
+  }).join();
+  EXPECT_EQ(result, again);
+  EXPECT_EQ(model.define("f(a)=sum(k,1,10,k^a)+a"), "");
+  EXPECT_EQ(model.compile("f(2)", &program), 1);
+  ASSERT_EQ(program.code.size(), 1u);
+  EXPECT_DOUBLE_EQ(program.constants[0], 387);
+  EXPECT_EQ(model.compile("sum(j,1,1000,sin(j*x)/j)", &program), 1);
+  EXPECT_EQ(program.loops.size(), 1u);
+  double x[3] = {0.5, 1, 2}, y[3], buffer[3];
+  const double *vars[2] = {x, NULL};
+  model.calculate_chunk(program, vars, 0, 3, buffer, y);
+  for (int j = 0; j < 3; j++) EXPECT_NEAR(y[j], (M_PI - x[j]) / 2, 1e-2);
+  EXPECT_EQ(model.calculate("f(x)", 1, &result), 1);
+  EXPECT_DOUBLE_EQ(result, 56);
+}
+
+TEST(Model_functions, Test5) {
+  s21::ModelFunctions model;
+  double result = 0;
+  EXPECT_EQ(model.calculate("sum(k,1,2.5,k)", 0, &result), -2);
+  EXPECT_EQ(model.calculate("sum(x,1,2,x)", 0, &result), -2);
+  EXPECT_EQ(model.calculate("sum(k,1,x,k)", 0, &result), -2);
+  EXPECT_EQ(model.calculate("sum(k,1,10)", 0, &result), -2);
+  EXPECT_EQ(model.calculate("sum(k,1,10,k*y)", 0, &result), -2);
+  EXPECT_EQ(model.calculate("sum(k,1,2,sum(j,1,2,j*k))", 0, &result), -2);
+  EXPECT_EQ(model.calculate("sum(k,1,2,sum(j,1,2,j))", 0, &result), 1);
+  EXPECT_DOUBLE_EQ(result, 6);
+  EXPECT_EQ(model.define("sum(a)=a"), "Incorrect definition");
+  EXPECT_EQ(model.calculate("sum(k,5,1,k)+prod(k,5,1,k)", 0, &result), 1);
+  EXPECT_DOUBLE_EQ(result, 1);
+  EXPECT_EQ(model.calculate("sum(k,0,10,1/k)", 0, &result), -1);
+}
+
+TEST(Model_functions, Test6) {
+  s21::ModelFunctions model;
+  double result = 0;
+  s21::MainModel::Program program;
+  EXPECT_EQ(model.compile("if(x<0, -x, sqrt(x)) + max(x, 1) - min(2, 3)",
+                          &program),
+            1);
+  double x[4] = {-4, 0, 0.25, 9}, y[4], buffer[12];
+  const double *vars[2] = {x, NULL};
+  model.calculate_chunk(program, vars, 0, 4, buffer, y);
+  for (int j = 0; j < 4; j++)
+    EXPECT_DOUBLE_EQ(y[j], (x[j] < 0 ? -x[j] : sqrt(x[j])) +
+                               (x[j] > 1 ? x[j] : 1) - 2);
+  EXPECT_EQ(model.compile("if(1>=2, 5, max(3, 4))", &program), 1);
+  ASSERT_EQ(program.code.size(), 1u);
+  EXPECT_DOUBLE_EQ(program.constants[0], 4);
+  EXPECT_EQ(model.calculate("if(x==1, 2, 3)*abs(x-3)", 1, &result), 1);
+  EXPECT_DOUBLE_EQ(result, 4);
+  EXPECT_EQ(model.calculate("if(x!=1, 2, 3)", 1, &result), 1);
+  EXPECT_DOUBLE_EQ(result, 3);
+  EXPECT_EQ(model.calculate("if(sqrt(x)>1, 1, 0)", -1, &result), -1);
+  EXPECT_EQ(model.calculate("if(x>0, 1)", 1, &result), -2);
+  EXPECT_EQ(model.calculate("min(1,2,3)", 1, &result), -2);
+  EXPECT_EQ(model.define("max(a,b)=a"), "Incorrect definition");
+}
+
+TEST(Model_complex, Test1) {
+  s21::ModelComplex model;
+  double re = 0, im = 0;
+  EXPECT_EQ(model.calculate_complex("sqrt(-4)", 0, 0, &re, &im), 1);
+  EXPECT_DOUBLE_EQ(re, 0);
+  EXPECT_DOUBLE_EQ(im, 2);
+  EXPECT_EQ(model.calculate_complex("ln(x)", -1, 0, &re, &im), 1);
+  EXPECT_DOUBLE_EQ(re, 0);
+  EXPECT_DOUBLE_EQ(im, M_PI);
+  std::complex<double> expected = std::asin(std::complex<double>(2, 0));
+  EXPECT_EQ(model.calculate_complex("asin(2)", 0, 0, &re, &im), 1);
+  EXPECT_DOUBLE_EQ(re, expected.real());
+  EXPECT_DOUBLE_EQ(im, expected.imag());
+  EXPECT_EQ(model.calculate_complex("i^2", 0, 0, &re, &im), 1);
+  EXPECT_EQ(re, -1);
+  EXPECT_EQ(im, 0);
+  EXPECT_EQ(model.calculate_complex("(1+2*i)*(3-i)", 0, 0, &re, &im), 1);
+  EXPECT_DOUBLE_EQ(re, 5);
+  EXPECT_DOUBLE_EQ(im, 5);
+  EXPECT_EQ(model.calculate_complex("(1+2*i)/(3-i)", 0, 0, &re, &im), 1);
+  EXPECT_DOUBLE_EQ(re, 0.1);
+  EXPECT_DOUBLE_EQ(im, 0.7);
+  EXPECT_EQ(model.calculate_complex("abs(3+4*i)+arg(i)", 0, 0, &re, &im), 1);
+  EXPECT_DOUBLE_EQ(re, 5 + M_PI / 2);
+  EXPECT_EQ(model.calculate_complex("conj(x)*i", 1, 2, &re, &im), 1);
+  EXPECT_DOUBLE_EQ(re, 2);
+  EXPECT_DOUBLE_EQ(im, 1);
+  double real = 0;
+  EXPECT_EQ(model.calculate("sin(x)+x^3/7-sqrt(x)", 1.3, &real), 1);
+  EXPECT_EQ(model.calculate_complex("sin(x)+x^3/7-sqrt(x)", 1.3, 0, &re, &im),
+            1);
+  EXPECT_EQ(re, real);
+  EXPECT_EQ(im, 0);
+  EXPECT_EQ(model.calculate_complex("if(x, i, 2)", 0, 1, &re, &im), 1);
+  EXPECT_DOUBLE_EQ(im, 1);
+  EXPECT_EQ(model.calculate_complex("if(x, i, 2)", 0, 0, &re, &im), 1);
+  EXPECT_DOUBLE_EQ(re, 2);
+  EXPECT_EQ(model.calculate_complex("ln(0)", 0, 0, &re, &im), -1);
+  EXPECT_EQ(model.calculate_complex("i<1", 0, 0, &re, &im), -1);
+  EXPECT_EQ(model.calculate_complex("sum(k,1,3,k)", 0, 0, &re, &im), -2);
+  EXPECT_EQ(model.calculate_complex("sin(i", 0, 0, &re, &im), -2);
+  EXPECT_EQ(model.calculate("2*i", 0, &real), -2);
+  EXPECT_EQ(model.calculate("arg(x)+conj(x)", -2, &real), 1);
+  EXPECT_DOUBLE_EQ(real, M_PI - 2);
+}
+
+TEST(Model_complex, Test2) {
+  s21::ModelComplex model;
+  double re = 0, im = 0;
+  model.set_complex(true);
+  EXPECT_EQ(model.define("f(z)=z*conj(z)+sqrt(-1)"), "");
+  EXPECT_EQ(model.calculate_complex("f(3+4*i)", 0, 0, &re, &im), 1);
+  EXPECT_DOUBLE_EQ(re, 25);
+  EXPECT_DOUBLE_EQ(im, 1);
+  s21::MainModel::Program program;
+  ASSERT_EQ(model.compile_complex("x^2+1", &program), 1);
+  double grid_re[9], grid_im[9];
+  model.calculate_grid(program, -1, 1, -1, 1, 3, grid_re, grid_im);
+  for (int iy = 0; iy < 3; iy++) {
+    for (int ix = 0; ix < 3; ix++) {
+      model.calculate_complex("x^2+1", ix - 1, iy - 1, &re, &im);
+      EXPECT_DOUBLE_EQ(grid_re[iy * 3 + ix], re);
+      EXPECT_DOUBLE_EQ(grid_im[iy * 3 + ix], im);
+    }
+  }
+  EXPECT_DOUBLE_EQ(grid_re[7], 0);
+  EXPECT_DOUBLE_EQ(grid_im[7], 0);
+}
+
+TEST(Model_complex, Test3) {
+  s21::ModelPrecise shared;
+  s21::MainModel::Program program;
+  EXPECT_EQ(shared.define("f(a)=2*a+1"), "");
+  shared.set_complex(true);
+  EXPECT_EQ(shared.compile_real("i*x", &program), -2);
+  ASSERT_EQ(shared.compile_real("f(x)", &program), 1);
+  EXPECT_TRUE(shared.get_complex());
+  double x[3] = {-1, 0, 2}, y[3], buffer[3 * 8];
+  const double *vars[2] = {x, NULL};
+  ASSERT_LE(program.depth, 8);
+  shared.calculate_chunk(program, vars, 0, 3, buffer, y);
+  for (int j = 0; j < 3; j++) EXPECT_DOUBLE_EQ(y[j], 2 * x[j] + 1);
+  ASSERT_EQ(shared.compile_precise("f(1)-2^0.5", &program), 1);
+  EXPECT_EQ(shared.load("./plugin.so", "phi"), "");
+  EXPECT_EQ(shared.define("g(a)=f(a)+phi(a)"), "");
+  ASSERT_EQ(shared.compile_real("g(x)", &program), 1);
+  ASSERT_EQ(program.plugins.size(), 1u);
+  ASSERT_LE(program.depth, 8);
+  shared.calculate_chunk(program, vars, 0, 3, buffer, y);
+  for (int j = 0; j < 3; j++)
+    EXPECT_DOUBLE_EQ(y[j], 2 * x[j] + 1 + erfc(-x[j] / sqrt(2)) / 2);
+  EXPECT_EQ(shared.compile_precise("phi(x)", &program), -2);
+}
+
+TEST(Model_precise, Test1) {
+  s21::ModelPrecise model;
+  std::string res;
+  EXPECT_EQ(model.calculate_precise("atan(1)*4", 0, 50, &res), 1);
+  EXPECT_EQ(res, "3.1415926535897932384626433832795028841971693993751");
+  EXPECT_EQ(model.calculate_precise("0.1+0.2", 0, 20, &res), 1);
+  EXPECT_EQ(res, "0.3");
+  EXPECT_EQ(model.calculate_precise("(1+10^(-15))-1", 0, 30, &res), 1);
+  EXPECT_EQ(res, "1e-15");
+  EXPECT_EQ(model.calculate_precise("ln(2)", 0, 30, &res), 1);
+  EXPECT_EQ(res, "0.693147180559945309417232121458");
+  EXPECT_EQ(model.calculate_precise("x^2", 0.1, 10, &res), 1);
+  EXPECT_EQ(res, "0.01");
+  EXPECT_EQ(model.calculate_precise("ln(x)", -1, 30, &res), -1);
+  EXPECT_EQ(model.calculate_precise("1/(x-x)", 2, 30, &res), -1);
+  EXPECT_EQ(model.calculate_precise("sum(k,1,3,k)", 0, 30, &res), -2);
+  EXPECT_EQ(model.calculate_precise("sin(", 0, 30, &res), -2);
+  const char *zeros[] = {"0.1+0.2-0.3", "2^0.5-sqrt(2)", "1 mod 0.1",
+                         "sin(atan(1)*4)"};
+  for (int k = 0; k < 4; k++) {
+    EXPECT_EQ(model.calculate_precise(zeros[k], 0, 40, &res), 1);
+    EXPECT_EQ(res, "0") << zeros[k];
+  }
+  EXPECT_EQ(model.calculate_precise(
+                "1.23456789012345678901234567891-1.2345678901234567", 0, 30,
+                &res),
+            1);
+  EXPECT_EQ(res, "8.901234567891e-17");
+  EXPECT_EQ(model.calculate_precise("0.1*3-0.1*3+0.123456789012345678901", 0,
+                                    30, &res),
+            1);
+  EXPECT_EQ(res, "0.123456789012345678901");
+}
+
+TEST(Model_precise, Test2) {
+  s21::ModelPrecise model;
+  s21::MainModel::Program program;
+  ASSERT_EQ(model.compile_precise("(1-cos(x))/x^2", &program), 1);
+  double x[4] = {1e-7, 1e-4, 0.5, 2};
+  double y[4];
+  EXPECT_GT(model.calculate_checked(program, x, 4, y), 0u);
+  EXPECT_NEAR(y[0], 0.5, 1e-12);
+  EXPECT_NEAR(y[1], 0.5 - 1e-8 / 24, 1e-12);
+  EXPECT_NEAR(y[2], (1 - cos(0.5)) / 0.25, 1e-12);
+  EXPECT_NEAR(y[3], (1 - cos(2)) / 4, 1e-12);
+  ASSERT_EQ(model.compile_precise("sin(x)+x^2/3", &program), 1);
+  EXPECT_EQ(model.calculate_checked(program, x, 4, y), 0u);
+  EXPECT_DOUBLE_EQ(y[3], sin(2) + 4.0 / 3);
+}
+
+TEST(Model_chebyshev, Test1) {
+  s21::ModelFunctions functions;
+  s21::ModelChebyshev proxy;
+  s21::MainModel::Program program;
+  char input[] = "sin(cos(x)^2)+atan(sin(3*x))*ln(2+cos(x))";
+  ASSERT_EQ(functions.compile(input, &program), 1);
+  ASSERT_EQ(proxy.build(program, -10, 10, 1e-10), 1);
+  EXPECT_LT(proxy.get_direct(), proxy.get_pieces());
+  std::vector<double> x(4001), y(4001);
+  for (size_t k = 0; k < x.size(); k++) x[k] = -10 + 0.005 * k;
+  proxy.evaluate(x.data(), x.size(), y.data());
+  for (size_t k = 0; k < x.size(); k++) {
+    char text[sizeof(input)];
+    strcpy(text, input);
+    double value = NAN;
+    if (proxy.final_func(text, &value, x[k]) == 1)
+      EXPECT_NEAR(y[k], value, 1e-9);
+    else
+      EXPECT_TRUE(isnan(y[k]));
+  }
+  EXPECT_TRUE(proxy.covers(program, -2, 3));
+  EXPECT_FALSE(proxy.covers(program, -11, 3));
+}
+
+TEST(Model_chebyshev, Test2) {
+  s21::ModelFunctions functions;
+  s21::ModelChebyshev proxy;
+  s21::MainModel::Program program, other;
+  char input[] = "sqrt(x)+1/(x-1)+tan(x)";
+  ASSERT_EQ(functions.compile(input, &program), 1);
+  ASSERT_EQ(proxy.build(program, -3, 5, 1e-10), 1);
+  EXPECT_GT(proxy.get_direct(), 0u);
+  std::vector<double> x(3001), y(3001);
+  for (size_t k = 0; k < x.size(); k++) x[k] = -4 + 0.003 * k;
+  proxy.evaluate(x.data(), x.size(), y.data());
+  for (size_t k = 0; k < x.size(); k++) {
+    char text[sizeof(input)];
+    strcpy(text, input);
+    double value = NAN;
+    if (proxy.final_func(text, &value, x[k]) == 1)
+      EXPECT_NEAR(y[k], value, 1e-9 * fmax(1, fabs(value)));
+    else
+      EXPECT_TRUE(isnan(y[k]));
+  }
+  ASSERT_EQ(functions.compile("sum(k,1,100,sin(k*x)/k^2)", &other), 1);
+  EXPECT_GE(proxy.cost(other), CHEBYSHEV_MIN_COST);
+  EXPECT_FALSE(proxy.covers(other, -1, 1));
+  ASSERT_EQ(proxy.build(other, 0, 2, 1e-10), 1);
+  double result = 0;
+  ASSERT_EQ(functions.calculate("sum(k,1,100,sin(k*x)/k^2)", 1.3, &result), 1);
+  double point = 1.3;
+  proxy.evaluate(&point, 1, &point);
+  EXPECT_NEAR(point, result, 1e-9);
+  other.code = {s21::MainModel::var_x, s21::MainModel::var_y,
+                s21::MainModel::op_plus};
+  other.constants.clear();
+  other.loops.clear();
+  other.depth = 2;
+  EXPECT_EQ(proxy.build(other, -1, 1, 1e-10), -2);
+  proxy.evaluate(x.data(), 1, y.data());
+  EXPECT_TRUE(isnan(y[0]));
+}
+
+TEST(Model_parallel, Test1) {
+  s21::ModelFunctions model;
+  s21::ModelParallel parallel;
+  s21::MainModel::Program program;
+  EXPECT_EQ(model.define("a(t)=sin(t)*cos(t/3)+atan(t^2)/(1+t^2)"), "");
+  EXPECT_EQ(model.define("b(t)=a(t)+a(t+1)*a(2*t)-a(t-1)/(2+a(t/2))"), "");
+  EXPECT_EQ(model.define("c(t)=b(t)+b(t+0.5)*b(t/3)-b(1-t)"), "");
+  EXPECT_EQ(model.define("d(t)=c(t)+c(t+0.25)-c(t*1.5)+c(t/7)"), "");
+  EXPECT_EQ(model.define("e(t)=d(t)+d(t+0.1)*0.5-d(t-0.3)+ln(d(t*t)+9)"), "");
+  std::string text = "e(x)+e(x/2)-e(3*x)";
+  ASSERT_EQ(model.compile(text, &program), 1);
+  EXPECT_GT(program.code.size(), (size_t)PARALLEL_MIN_COST);
+  EXPECT_GT(parallel.build(program, 4), 1u);
+  double points[4] = {-2.5, 0.37, 1, 40};
+  for (int j = 0; j < 4; j++) {
+    double x = points[j], y = 0, serial = 0;
+    const double *vars[2] = {&x, &y};
+    std::vector<double> buffer(program.depth);
+    model.calculate_chunk(program, vars, 0, 1, buffer.data(), &serial);
+    double value = parallel.evaluate(vars);
+    EXPECT_TRUE(value == serial || (isnan(value) && isnan(serial)));
+  }
+  double serial = 0, result = 0;
+  EXPECT_EQ(model.calculate(text, 0.37, &serial), 1);
+  model.set_parallel(true);
+  EXPECT_EQ(model.calculate(text, 0.37, &result), 1);
+  EXPECT_EQ(result, serial);
+  ASSERT_EQ(model.compile("a(x)+1", &program), 1);
+  EXPECT_EQ(parallel.build(program, 4), 0u);
+}
+
+TEST(Model_parallel, Test2) {
+  s21::ModelFunctions model;
+  s21::ModelParallel parallel;
+  s21::MainModel::Program program;
+  std::string text =
+      "sum(k,1,20000,sin(k*x)/k^2)-sum(k,1,20000,cos(k*x)/k^2)+x";
+  ASSERT_EQ(model.compile(text, &program), 1);
+  EXPECT_EQ(parallel.build(program, 2), 2u);
+  double x = 0.5, y = 0, serial = 0;
+  const double *vars[2] = {&x, &y};
+  EXPECT_EQ(model.calculate(text, x, &serial), 1);
+  EXPECT_EQ(parallel.evaluate(vars), serial);
+  EXPECT_EQ(parallel.build(program, 1), 0u);
+  EXPECT_EQ(parallel.evaluate(vars), serial);
+}
+
 TEST(Model_credit, Test1) {
   s21::ModelCredit model;
   model.check("100000", "12", "13", "Annuitentnie");
@@ -155,6 +749,623 @@ TEST(Model_credit, Test3) {
   EXPECT_EQ(model.get_sum_total(), "107041.666667");
 }
 
+TEST(Model_credit, Test4) {
+  s21::ModelCredit model;
+  double principal[] = {100000, 100000, 50000}, fee[] = {0, 2000, 0};
+  double payment[] = {8931.727571, 8931.727571, 50000.0 / 24};
+  int time[] = {12, 12, 24};
+  double apr[3];
+  model.calculate_apr_batch(principal, fee, payment, time, apr, 3);
+  EXPECT_NEAR(apr[0], 13, 1e-6);
+  EXPECT_GT(apr[1], 13);
+  EXPECT_NEAR(apr[2], 0, 1e-9);
+  double r = apr[1] / 1200, value = 0;
+  for (int k = 1; k <= 12; k++) value += payment[1] / pow(1 + r, k);
+  EXPECT_NEAR(value, principal[1] - fee[1], 1e-6);
+}
+
+TEST(Model_credit, Test5) {
+  s21::ModelCredit model;
+  double payments[12];
+  for (int k = 0; k < 12; k++)
+    payments[k] = 100000.0 / 12 + (100000 - 100000.0 / 12 * k) * 0.13 / 12;
+  EXPECT_NEAR(model.calculate_apr(100000, 0, payments, 12), 13, 1e-9);
+  double zero[12] = {0};
+  EXPECT_TRUE(isnan(model.calculate_apr(100000, 0, zero, 12)));
+}
+
+TEST(Model_credit, Test6) {
+  s21::ModelCredit model;
+  EXPECT_NEAR(model.max_principal(8931.727571, 13, 12, "Annuitentnie"),
+              100000, 1e-3);
+  EXPECT_NEAR(model.max_principal(9416.666667, 13, 12, "Differentials"),
+              100000, 1e-3);
+  EXPECT_EQ(model.min_time(100000, 8931.73, 13, "Annuitentnie"), 12);
+  EXPECT_EQ(model.min_time(100000, 8931.72, 13, "Annuitentnie"), 13);
+  EXPECT_EQ(model.min_time(100000, 9416.67, 13, "Differentials"), 12);
+  EXPECT_EQ(model.min_time(100000, 1000, 13, "Annuitentnie"), 0);
+  EXPECT_EQ(model.min_time(100000, 50, 0, "Annuitentnie"), 0);
+}
+
+TEST(Model_credit, Test7) {
+  s21::ModelCredit model;
+  double payment[] = {1000, 2500, 8931.73}, precent[] = {0, 7.5, 13};
+  double principal[] = {12000, 60000, 100000}, res[3];
+  int time[] = {12, 36, 12}, months[3];
+  model.max_principal_batch(payment, precent, time, res, 3, "Annuitentnie");
+  model.min_time_batch(principal, payment, precent, months, 3, "Annuitentnie");
+  for (int k = 0; k < 3; k++) {
+    EXPECT_DOUBLE_EQ(res[k], model.max_principal(payment[k], precent[k],
+                                                 time[k], "Annuitentnie"));
+    EXPECT_EQ(months[k], model.min_time(principal[k], payment[k], precent[k],
+                                        "Annuitentnie"));
+  }
+  EXPECT_EQ(months[0], 12);
+  EXPECT_EQ(months[1], 27);
+}
+
+TEST(Model_credit, Test8) {
+  s21::ModelCredit model;
+  double principal[] = {100000, 100000, 30000}, precent[] = {13, 13, 0};
+  int time[] = {12, 12, 6}, start[] = {0, 3, 10};
+  model.calculate_portfolio(principal, precent, time, start, 3,
+                            "Annuitentnie");
+  std::vector<double> p = model.get_portfolio_principal();
+  std::vector<double> i = model.get_portfolio_interest();
+  ASSERT_EQ(p.size(), 16u);
+  double balance = 100000, total_p = 0, total_i = 0;
+  for (int m = 0; m < 16; m++) {
+    total_p += p[m];
+    total_i += i[m];
+  }
+  EXPECT_NEAR(total_p, 230000, 1e-6);
+  EXPECT_NEAR(total_i, 2 * 7180.730854, 1e-4);
+  for (int m = 0; m < 3; m++) {
+    EXPECT_NEAR(i[m], balance * 0.13 / 12, 1e-6);
+    balance -= 8931.727571 - balance * 0.13 / 12;
+  }
+  EXPECT_NEAR(p[15], 5000, 1e-6);
+  model.calculate_portfolio(principal, precent, time, start, 3,
+                            "Differentials");
+  p = model.get_portfolio_principal();
+  i = model.get_portfolio_interest();
+  EXPECT_NEAR(p[5], 2 * 100000.0 / 12, 1e-6);
+  EXPECT_NEAR(i[3], 100000 * 0.13 / 12 + (100000 - 100000.0 / 4) * 0.13 / 12,
+              1e-6);
+  EXPECT_NEAR(i[14], (100000 - 100000.0 / 12 * 11) * 0.13 / 12, 1e-6);
+  EXPECT_NEAR(i[15], 0, 1e-6);
+  std::vector<double> many_principal, many_precent;
+  std::vector<int> many_time, many_start;
+  for (int k = 0; k < 200; k++) {
+    many_principal.push_back(10000 + 137 * k);
+    many_precent.push_back(k % 80 * 0.25);
+    many_time.push_back(12 + k % 7 * 50);
+    many_start.push_back(k % 13 * 5);
+  }
+  model.calculate_portfolio(many_principal.data(), many_precent.data(),
+                            many_time.data(), many_start.data(), 200,
+                            "Annuitentnie");
+  p = model.get_portfolio_principal();
+  i = model.get_portfolio_interest();
+  std::vector<double> expected_p(p.size(), 0), expected_i(p.size(), 0);
+  for (int k = 0; k < 200; k++) {
+    double r = many_precent[k] / 1200, rest = many_principal[k];
+    int n = many_time[k];
+    double annuity = r > 0 ? rest * r / (1 - pow(1 + r, -n)) : rest / n;
+    for (int m = 0; m < n; m++) {
+      expected_i[many_start[k] + m] += rest * r;
+      expected_p[many_start[k] + m] += annuity - rest * r;
+      rest -= annuity - rest * r;
+    }
+  }
+  ASSERT_EQ(p.size(), 372u);
+  for (size_t m = 0; m < p.size(); m++) {
+    EXPECT_NEAR(p[m], expected_p[m], 1e-6 * (1 + expected_p[m]));
+    EXPECT_NEAR(i[m], expected_i[m], 1e-6 * (1 + expected_i[m]));
+  }
+}
+
+TEST(Model_credit, Test9) {
+  s21::ModelCredit model;
+  const char *types[] = {"Annuitentnie", "Differentials"};
+  for (int t = 0; t < 2; t++) {
+    s21::ModelCredit::Sensitivity s =
+        model.calculate_sensitivity(100000, 13, 12, types[t]);
+    s21::ModelCredit::Sensitivity up =
+        model.calculate_sensitivity(100000, 13 + 1e-5, 12, types[t]);
+    s21::ModelCredit::Sensitivity down =
+        model.calculate_sensitivity(100000, 13 - 1e-5, 12, types[t]);
+    EXPECT_NEAR(s.payment_rate, (up.payment - down.payment) / 2e-5, 1e-4);
+    EXPECT_NEAR(s.total_rate, (up.total - down.total) / 2e-5, 1e-4);
+    double value = 0, moment = 0, moment2 = 0, y = 0.13 / 12;
+    for (int k = 1; k <= 12; k++) {
+      double flow = t ? 100000.0 / 12 + (100000 - 100000.0 / 12 * (k - 1)) * y
+                      : s.payment;
+      value += flow / pow(1 + y, k);
+      moment += k / 12.0 * flow / pow(1 + y, k + 1);
+      moment2 += k * (k + 1) / 144.0 * flow / pow(1 + y, k + 2);
+    }
+    EXPECT_NEAR(value, 100000, 1e-4);
+    EXPECT_NEAR(s.duration, moment / value, 1e-12);
+    EXPECT_NEAR(s.convexity, moment2 / value, 1e-12);
+  }
+  s21::ModelCredit::Sensitivity s =
+      model.calculate_sensitivity(100000, 13, 12, "Annuitentnie");
+  EXPECT_NEAR(s.payment, 8931.727571, 1e-6);
+  EXPECT_NEAR(s.total, 107180.730854, 1e-5);
+  double a = 0.13 / 12, n = 12, q = pow(1 + a, n);
+  double dn = -100000 * a * q * log(1 + a) / ((q - 1) * (q - 1));
+  EXPECT_NEAR(s.payment_time, dn, 1e-6);
+  EXPECT_NEAR(s.total_time, s.payment + n * dn, 1e-6);
+  s = model.calculate_sensitivity(120000, 0, 12, "Annuitentnie");
+  EXPECT_NEAR(s.payment, 10000, 1e-9);
+  EXPECT_NEAR(s.payment_time, -120000.0 / 144, 1e-9);
+  EXPECT_NEAR(s.payment_rate, 120000.0 * 13 / 24 / 1200, 1e-9);
+  double principal[] = {100000, 120000}, precent[] = {13, 0};
+  int time[] = {12, 12};
+  s21::ModelCredit::Sensitivity batch[2];
+  model.calculate_sensitivity_batch(principal, precent, time, batch, 2,
+                                    "Differentials");
+  s = model.calculate_sensitivity(120000, 0, 12, "Differentials");
+  EXPECT_DOUBLE_EQ(batch[1].total_rate, s.total_rate);
+  EXPECT_DOUBLE_EQ(batch[1].duration, s.duration);
+}
+
+TEST(Model_credit, Test10) {
+  s21::ModelCredit model;
+  const char *types[] = {"Annuitentnie", "Differentials"};
+  for (int t = 0; t < 2; t++) {
+    double r = 0.13 / 12, r2 = 0.09 / 12, balance = 100000, payment = 0;
+    for (int k = 0; k < 12; k++) {
+      double annuity = 100000 * r / (1 - pow(1 + r, -36));
+      payment = t ? 100000.0 / 36 + balance * r : annuity;
+      balance -= payment - balance * r;
+    }
+    double old_balance = balance, new_balance = balance, gain = 0;
+    double new_payment = balance * r2 / (1 - pow(1 + r2, -36));
+    int break_even = 0;
+    for (int k = 1; k <= 36; k++) {
+      double old_interest = old_balance * r, new_interest = new_balance * r2;
+      if (k <= 24)
+        old_balance -= (t ? balance / 24 : payment - old_interest);
+      new_balance -= (t ? balance / 36 : new_payment - new_interest);
+      gain += old_interest - new_interest;
+      if (!break_even && gain >= 1500) break_even = k;
+    }
+    s21::ModelCredit::Refinance res =
+        model.calculate_refinance(100000, 13, 36, 12, 9, 36, 1500, types[t]);
+    EXPECT_NEAR(res.balance, balance, 1e-6);
+    EXPECT_EQ(res.break_even, break_even);
+    EXPECT_NEAR(res.saving, gain - 1500, 1e-6);
+  }
+  double rates[] = {9, 12, 15};
+  int times[] = {12, 24};
+  s21::ModelCredit::Refinance grid[6];
+  model.calculate_refinance_batch(100000, 13, 36, 12, rates, 3, times, 2, 500,
+                                  grid, "Annuitentnie");
+  s21::ModelCredit::Refinance res = model.calculate_refinance(
+      100000, 13, 36, 12, 12, 24, 500, "Annuitentnie");
+  EXPECT_EQ(grid[3].break_even, res.break_even);
+  EXPECT_DOUBLE_EQ(grid[3].saving, res.saving);
+  EXPECT_EQ(grid[5].break_even, 0);
+  EXPECT_LT(grid[5].saving, 0);
+}
+
+TEST(Model_credit, Test11) {
+  s21::ModelCredit model;
+  double payment = 0, principal = 0, interest = 0, rest = 0;
+  EXPECT_EQ(model.get_schedule_rows(), 0);
+  EXPECT_FALSE(model.get_schedule_row(1, &payment, &principal, &interest,
+                                      &rest));
+  model.check("100000", "12", "13", "Annuitentnie");
+  model.calculate();
+  ASSERT_EQ(model.get_schedule_rows(), 12);
+  double balance = 100000;
+  for (int k = 1; k <= 12; k++) {
+    ASSERT_TRUE(model.get_schedule_row(k, &payment, &principal, &interest,
+                                       &rest));
+    EXPECT_NEAR(payment, 8931.727571, 1e-6);
+    EXPECT_NEAR(interest, balance * 0.13 / 12, 1e-6);
+    balance -= principal;
+    EXPECT_NEAR(rest, balance, 1e-6);
+  }
+  EXPECT_NEAR(rest, 0, 1e-9);
+  EXPECT_FALSE(model.get_schedule_row(13, &payment, &principal, &interest,
+                                      &rest));
+  model.check("100000", "12", "13", "Differentials");
+  model.calculate();
+  model.get_schedule_row(1, &payment, &principal, &interest, &rest);
+  EXPECT_NEAR(payment, 9416.666667, 1e-6);
+  model.get_schedule_row(12, &payment, &principal, &interest, &rest);
+  EXPECT_NEAR(payment, 8423.611111, 1e-6);
+}
+
+TEST(Model_credit, Test12) {
+  s21::ModelCredit model;
+  EXPECT_TRUE(s21::ModelCredit::valid_loan(100000000, 1200, 100));
+  EXPECT_TRUE(s21::ModelCredit::valid_loan(1, 1, 0));
+  EXPECT_FALSE(s21::ModelCredit::valid_loan(0, 12, 13));
+  EXPECT_FALSE(s21::ModelCredit::valid_loan(100000, 12.5, 13));
+  EXPECT_FALSE(s21::ModelCredit::valid_loan(100000, 1201, 13));
+  EXPECT_FALSE(s21::ModelCredit::valid_loan(100000, 12, -1));
+  EXPECT_FALSE(s21::ModelCredit::valid_loan(NAN, 12, 13));
+  double sum[] = {100000, 100000, -5, 120000}, time[] = {12, 12, 12, 24};
+  double precent[] = {13, 7.25, 13, 0};
+  double first[4], last[4], overpayment[4], total[4];
+  model.calculate_batch(sum, time, precent, 4, "Differentials", first, last,
+                        overpayment, total);
+  EXPECT_DOUBLE_EQ(first[3], 5000);
+  EXPECT_DOUBLE_EQ(overpayment[3], 0);
+  model.check("100000", "12", "13", "Differentials");
+  model.calculate();
+  EXPECT_EQ(std::to_string(first[0]) + ".." + std::to_string(last[0]),
+            model.get_payment());
+  EXPECT_NEAR(overpayment[0], 7041.666667, 1e-6);
+  EXPECT_TRUE(isnan(total[2]));
+  model.calculate_batch(sum, time, precent, 4, "Annuitentnie", first, last,
+                        overpayment, total);
+  model.check("100000", "12", "7.25", "Annuitentnie");
+  model.calculate();
+  EXPECT_EQ(std::to_string(first[1]), model.get_payment());
+  EXPECT_EQ(std::to_string(total[1]), model.get_sum_total());
+  EXPECT_DOUBLE_EQ(first[3], 5000);
+  EXPECT_DOUBLE_EQ(overpayment[3], 0);
+  model.check("120000", "24", "0", "Annuitentnie");
+  model.calculate();
+  EXPECT_EQ(std::to_string(first[3]), model.get_payment());
+  EXPECT_EQ(std::to_string(total[3]), model.get_sum_total());
+}
+
+TEST(Model_credit, Test13) {
+  s21::ModelCredit model;
+  double precent[] = {0, 7.5, 13}, principal[] = {100000, 250000};
+  int time[] = {12, 60, 1200};
+  std::vector<double> payment(18), overpayment(18);
+  const char *types[] = {"Annuitentnie", "Differentials"};
+  for (int t = 0; t < 2; t++) {
+    model.calculate_grid(precent, 3, time, 3, principal, 2, types[t],
+                         payment.data(), overpayment.data());
+    for (int p = 0; p < 2; p++)
+      for (int r = 1; r < 3; r++)
+        for (int n = 0; n < 3; n++) {
+          model.check(std::to_string((int)principal[p]),
+                      std::to_string(time[n]), std::to_string(precent[r]),
+                      types[t]);
+          model.calculate();
+          size_t cell = (p * 3 + r) * 3 + n;
+          std::string expected = model.get_payment();
+          EXPECT_EQ(std::to_string(payment[cell]),
+                    expected.substr(0, expected.find("..")));
+          EXPECT_NEAR(overpayment[cell], std::stod(model.get_overpayment()),
+                      1e-6 * principal[p]);
+        }
+  }
+  model.calculate_grid(precent, 3, time, 3, principal, 2, "Annuitentnie",
+                       payment.data(), overpayment.data());
+  EXPECT_DOUBLE_EQ(payment[9 + 1], 250000.0 / 60);
+  EXPECT_DOUBLE_EQ(overpayment[1], 0);
+}
+
+TEST(Model_credit, Test14) {
+  s21::ModelCredit model;
+  const char *types[] = {"Annuitentnie", "Differentials"};
+  double rates[] = {3, 5.5, 6, 7, 9};
+  int times[] = {120, 240, 300, 360, 480};
+  for (int t = 0; t < 2; t++)
+    for (int paid = 0; paid <= 24; paid += 24)
+      for (int r = 0; r < 5; r++)
+        for (int n = 0; n < 5; n++) {
+          double r1 = 0.06 / 12, r2 = rates[r] / 1200, rest = 300000;
+          double annuity = 300000 * r1 / (1 - pow(1 + r1, -360));
+          for (int k = 0; k < paid; k++)
+            rest -= t ? 300000.0 / 360 : annuity - rest * r1;
+          double new_annuity = r2 > 0
+                                   ? rest * r2 / (1 - pow(1 + r2, -times[n]))
+                                   : rest / times[n];
+          double old_balance = rest, new_balance = rest, gain = 0;
+          int break_even = 0;
+          for (int k = 1; k <= 360 - paid || k <= times[n]; k++) {
+            double old_interest = old_balance * r1;
+            double new_interest = new_balance * r2;
+            if (k <= 360 - paid)
+              old_balance -= t ? 300000.0 / 360 : annuity - old_interest;
+            if (k <= times[n])
+              new_balance -= t ? rest / times[n] : new_annuity - new_interest;
+            gain += old_interest - new_interest;
+            if (!break_even && gain >= 777.7) break_even = k;
+          }
+          s21::ModelCredit::Refinance res = model.calculate_refinance(
+              300000, 6, 360, paid, rates[r], times[n], 777.7, types[t]);
+          EXPECT_EQ(res.break_even, break_even)
+              << types[t] << " " << paid << " " << rates[r] << " "
+              << times[n];
+          EXPECT_NEAR(res.saving, gain - 777.7, 1e-4);
+        }
+  s21::ModelCredit::Refinance res = model.calculate_refinance(
+      300000, 6, 360, 0, 7, 300, 500, "Annuitentnie");
+  EXPECT_EQ(res.break_even, 310);
+  EXPECT_GT(res.saving, 0);
+}
+
+TEST(Model_credit, Test15) {
+  double values[] = {1280.1033184999999, 1280.1033185, 0.0000005,
+                     -0.0000004, -2.5, 123456789.987654, 1e15, 0};
+  std::vector<double> all(values, values + 8);
+  for (int k = 0; k < 1000; k++) all.push_back(k * 1234.56789012345 / 7);
+  char text[64];
+  for (size_t k = 0; k < all.size(); k++) {
+    char *end =
+        s21::ModelCredit::write_fixed(text, text + sizeof(text), all[k]);
+    EXPECT_EQ(std::string(text, end), std::to_string(all[k]));
+  }
+  EXPECT_EQ(s21::ModelCredit::write_fixed(text, text + 4, 1280.5), text);
+}
+
+TEST(Model_calendar, Test1) {
+  s21::ModelCalendar calendar;
+  int year = 0, month = 0, day = 0;
+  EXPECT_EQ(calendar.to_day(1970, 1, 1), 0);
+  EXPECT_EQ(calendar.to_day(2000, 3, 1), 11017);
+  for (int number = 0; number < 80000; number += 97) {
+    calendar.from_day(number, &year, &month, &day);
+    EXPECT_EQ(calendar.to_day(year, month, day), number);
+  }
+  calendar.from_day(calendar.to_day(2024, 12, 31), &year, &month, &day);
+  EXPECT_EQ(year * 10000 + month * 100 + day, 20241231);
+  int jan31 = calendar.to_day(2024, 1, 31);
+  EXPECT_EQ(calendar.add_months(jan31, 1), calendar.to_day(2024, 2, 29));
+  EXPECT_EQ(calendar.add_months(jan31, 13), calendar.to_day(2025, 2, 28));
+  EXPECT_FALSE(calendar.is_business(calendar.to_day(2024, 1, 6)));
+  EXPECT_TRUE(calendar.is_business(calendar.to_day(2024, 1, 8)));
+  EXPECT_EQ(calendar.adjust(calendar.to_day(2024, 3, 9)),
+            calendar.to_day(2024, 3, 11));
+  EXPECT_EQ(calendar.adjust(calendar.to_day(2024, 6, 30)),
+            calendar.to_day(2024, 6, 28));
+  calendar.add_holiday(calendar.to_day(2024, 3, 11));
+  EXPECT_EQ(calendar.adjust(calendar.to_day(2024, 3, 9)),
+            calendar.to_day(2024, 3, 12));
+  EXPECT_DOUBLE_EQ(
+      calendar.year_fraction(calendar.to_day(2024, 1, 31),
+                             calendar.to_day(2024, 3, 31),
+                             s21::ModelCalendar::thirty_360),
+      60.0 / 360);
+  EXPECT_DOUBLE_EQ(calendar.year_fraction(calendar.to_day(2024, 1, 1),
+                                          calendar.to_day(2025, 1, 1),
+                                          s21::ModelCalendar::act_365),
+                   366.0 / 365);
+  EXPECT_DOUBLE_EQ(calendar.year_fraction(0, 90, s21::ModelCalendar::act_360),
+                   0.25);
+}
+
+TEST(Model_calendar, Test2) {
+  s21::ModelCalendar calendar;
+  s21::ModelCredit model;
+  int dates[12];
+  double payment[12], interest[12], rest[12];
+  int start = calendar.to_day(2024, 1, 15);
+  ASSERT_TRUE(model.calculate_dated(100000, 13, 3, start,
+                                    s21::ModelCalendar::thirty_360,
+                                    "Annuitentnie", calendar, dates, payment,
+                                    interest, rest));
+  model.check("100000", "3", "13", "Annuitentnie");
+  model.calculate();
+  EXPECT_EQ(std::to_string(payment[0]), model.get_payment());
+  EXPECT_EQ(dates[2], calendar.to_day(2024, 4, 15));
+  ASSERT_TRUE(model.calculate_dated(100000, 13, 12, start,
+                                    s21::ModelCalendar::act_365,
+                                    "Annuitentnie", calendar, dates, payment,
+                                    interest, rest));
+  EXPECT_EQ(dates[4], calendar.to_day(2024, 6, 17));
+  EXPECT_NEAR(interest[0], 100000 * 0.13 * 31 / 365, 1e-9);
+  double balance = 100000;
+  for (int k = 0; k < 12; k++) {
+    EXPECT_NEAR(payment[k], payment[0], 1e-6);
+    balance -= payment[k] - interest[k];
+  }
+  EXPECT_NEAR(balance, 0, 1e-6);
+  ASSERT_TRUE(model.calculate_dated(120000, 10, 12, start,
+                                    s21::ModelCalendar::act_360,
+                                    "Differentials", calendar, dates, payment,
+                                    interest, rest));
+  EXPECT_NEAR(payment[1] - interest[1], 10000, 1e-9);
+  EXPECT_NEAR(interest[1], 110000 * 0.1 * 29 / 360, 1e-9);
+  EXPECT_FALSE(model.calculate_dated(100000, 13, 12, -1,
+                                     s21::ModelCalendar::act_365,
+                                     "Annuitentnie", calendar, dates, payment,
+                                     interest, rest));
+  int last = calendar.last_day();
+  EXPECT_FALSE(model.calculate_dated(100000, 13, 1200, last - 10,
+                                     s21::ModelCalendar::act_365,
+                                     "Annuitentnie", calendar, dates, payment,
+                                     interest, rest));
+  EXPECT_FALSE(model.calculate_dated(100000, 13, 12, last + 100,
+                                     s21::ModelCalendar::act_365,
+                                     "Annuitentnie", calendar, dates, payment,
+                                     interest, rest));
+  int year = 0, month = 0, day = 0;
+  EXPECT_EQ(calendar.add_months(last - 10, 1200), -1);
+  EXPECT_EQ(calendar.add_months(0, -1), -1);
+  EXPECT_EQ(calendar.to_day(1970 + CALENDAR_YEARS, 1, 1), -1);
+  EXPECT_EQ(calendar.to_day(1969, 12, 31), -1);
+  EXPECT_FALSE(calendar.from_day(last + 1, &year, &month, &day));
+  EXPECT_TRUE(calendar.from_day(last, &year, &month, &day));
+  EXPECT_EQ(calendar.to_day(year, month, day), last);
+  EXPECT_EQ(calendar.adjust(last + 5), last + 5);
+  EXPECT_FALSE(calendar.is_business(-1));
+}
+
+TEST(Model_data, Test1) {
+  s21::ModelData model;
+  std::string path = testing::TempDir() + "smartcalc_data.csv";
+  FILE* file = fopen(path.c_str(), "w");
+  fprintf(file, "time,\"price\"\r\n0.5,1e3\r\n-2,abc\r\n3.25, 7\r\n");
+  fclose(file);
+  EXPECT_EQ(model.load(path), "");
+  EXPECT_EQ(model.get_rows(), 3u);
+  EXPECT_EQ(model.get_columns(), 2u);
+  EXPECT_EQ(model.get_name(1), "price");
+  EXPECT_DOUBLE_EQ(model.get_column(0)[0], 0.5);
+  EXPECT_DOUBLE_EQ(model.get_column(1)[0], 1000);
+  EXPECT_TRUE(isnan(model.get_column(1)[1]));
+  EXPECT_DOUBLE_EQ(model.get_column(0)[2], 3.25);
+  EXPECT_DOUBLE_EQ(model.get_column(1)[2], 7);
+  remove(path.c_str());
+}
+
+TEST(Model_data, Test2) {
+  s21::ModelData model;
+  std::string path = testing::TempDir() + "smartcalc_data.csv";
+  FILE* file = fopen(path.c_str(), "w");
+  fprintf(file, "1;0.1\n2;0.30000000000000004\n3;123456789012345678901");
+  fclose(file);
+  EXPECT_EQ(model.load(path), "");
+  EXPECT_EQ(model.get_rows(), 3u);
+  EXPECT_EQ(model.get_name(0), "col1");
+  EXPECT_DOUBLE_EQ(model.get_column(1)[0], 0.1);
+  EXPECT_EQ(model.get_column(1)[1], 0.30000000000000004);
+  EXPECT_EQ(model.get_column(1)[2], 123456789012345678901.0);
+  remove(path.c_str());
+}
+
+TEST(Model_data, Test3) {
+  s21::ModelData model;
+  std::string path = testing::TempDir() + "smartcalc_data.bin";
+  double values[6] = {1, 2, 3, 4, 5, 6};
+  FILE* file = fopen(path.c_str(), "wb");
+  fwrite(values, sizeof(double), 6, file);
+  fclose(file);
+  EXPECT_EQ(model.load(path), "");
+  EXPECT_EQ(model.get_rows(), 3u);
+  EXPECT_DOUBLE_EQ(model.get_column(1)[2], 6);
+  remove(path.c_str());
+  EXPECT_EQ(model.load(path), "Cannot open file");
+}
+
+TEST(Model_data, Test4) {
+  s21::ModelData model;
+  std::string path = testing::TempDir() + "smartcalc_data.csv";
+  FILE* file = fopen(path.c_str(), "w");
+  fprintf(file, "price,qty,price2\n");
+  for (int r = 1; r <= 1000; r++) fprintf(file, "%d,%d,%d\n", r, r % 7, -r);
+  fclose(file);
+  EXPECT_EQ(model.add_column("cost", "price*qty"), "No data");
+  EXPECT_EQ(model.load(path), "");
+  EXPECT_EQ(model.add_column("cost", "ln(price) * qty - price2"), "");
+  EXPECT_EQ(model.get_columns(), 4u);
+  EXPECT_EQ(model.get_name(3), "cost");
+  for (int r = 1; r <= 1000; r++)
+    EXPECT_DOUBLE_EQ(model.get_column(3)[r - 1], log(r) * (r % 7) + r);
+  EXPECT_EQ(model.add_column("root", "sqrt(price2)"), "");
+  EXPECT_TRUE(isnan(model.get_column(4)[0]));
+  EXPECT_EQ(model.add_column("cost", "price"), "Incorrect name");
+  EXPECT_EQ(model.add_column("sin", "price"), "Incorrect name");
+  EXPECT_EQ(model.add_column("other", "price*x"), "Incorrect input");
+  EXPECT_EQ(model.add_column("other", "price*volume"), "Incorrect input");
+  remove(path.c_str());
+}
+
+TEST(Model_data, Test5) {
+  s21::ModelData model;
+  std::string path = testing::TempDir() + "smartcalc_data.csv";
+  FILE* file = fopen(path.c_str(), "w");
+  fprintf(file, "n,v,s,t,g,d\n2,3,0.5,4,10,7\n");
+  fclose(file);
+  EXPECT_EQ(model.load(path), "");
+  EXPECT_EQ(model.add_column("z", "ln(n)"), "");
+  EXPECT_DOUBLE_EQ(model.get_column(6)[0], log(2));
+  EXPECT_EQ(model.add_column("w", "ln(v)+cos(s)-sqrt(t)"), "");
+  EXPECT_DOUBLE_EQ(model.get_column(7)[0], log(3) + cos(0.5) - 2);
+  EXPECT_EQ(model.add_column("m", "log(g) + (d) mod 4"), "");
+  EXPECT_DOUBLE_EQ(model.get_column(8)[0], 4);
+  remove(path.c_str());
+  path = testing::TempDir() + "smartcalc_data.bin";
+  double values[4] = {1, 2, 3, 4};
+  file = fopen(path.c_str(), "wb");
+  fwrite(values, sizeof(double), 4, file);
+  fclose(file);
+  EXPECT_EQ(model.load(path), "");
+  EXPECT_EQ(model.add_column("sum_xy", "x + 10 * y"), "");
+  EXPECT_DOUBLE_EQ(model.get_column(2)[1], 43);
+  remove(path.c_str());
+}
+
+TEST(Model_fit, Test1) {
+  s21::ModelFit model;
+  std::vector<double> x(20000), y(20000);
+  for (size_t j = 0; j < x.size(); j++) {
+    x[j] = j * 0.001;
+    y[j] = 2.5 * sin(1.3 * x[j]) + 0.7 + 0.01 * sin(977.0 * j);
+  }
+  EXPECT_EQ(model.fit("a*sin(b*x)+c", "a=2, b=1.2, c", x.data(), y.data(),
+                      x.size()),
+            "");
+  EXPECT_TRUE(model.get_converged());
+  EXPECT_EQ(model.get_name(1), "b");
+  EXPECT_NEAR(model.get_value(0), 2.5, 1e-3);
+  EXPECT_NEAR(model.get_value(1), 1.3, 1e-3);
+  EXPECT_NEAR(model.get_value(2), 0.7, 1e-3);
+  EXPECT_NEAR(model.get_residual(), 0.01 / sqrt(2), 1e-3);
+  double curve = 0, at = 1;
+  model.calculate_curve(&at, &curve, 1);
+  EXPECT_NEAR(curve, 2.5 * sin(1.3) + 0.7, 1e-3);
+}
+
+TEST(Model_fit, Test2) {
+  s21::ModelFit model;
+  double x[3] = {1, 2, 3}, y[3] = {2, 4, 6};
+  EXPECT_EQ(model.fit("k*x", "k=", x, y, 3), "Incorrect parameters");
+  EXPECT_EQ(model.fit("k*x", "sin=1", x, y, 3), "Incorrect parameters");
+  EXPECT_EQ(model.fit("k*z", "k", x, y, 3), "Incorrect input");
+  EXPECT_EQ(model.fit("ln(k)*x", "k=-1", x, y, 3),
+            "Incorrect initial parameters");
+  EXPECT_EQ(model.fit("k*x", "k", x, y, 3), "");
+  EXPECT_NEAR(model.get_value(0), 2, 1e-9);
+  double c[3];
+  for (int j = 0; j < 3; j++) c[j] = 1.5 * cos(x[j]) + 0.5 * sqrt(x[j]);
+  EXPECT_EQ(model.fit("s*cos(x)+t*sqrt(x)", "s=1, t", x, c, 3), "");
+  EXPECT_NEAR(model.get_value(0), 1.5, 1e-6);
+  EXPECT_NEAR(model.get_value(1), 0.5, 1e-6);
+  EXPECT_EQ(model.fit("n*ln(x)+g*log(x)", "n, g", x, y, 3), "");
+}
+
+TEST(Model_spectrum, Test1) {
+  s21::ModelSpectrum model;
+  const size_t n = 64;
+  double re[n], im[n], source[n];
+  for (size_t j = 0; j < n; j++) {
+    source[j] = sin(j * 0.37) + (j % 5) * 0.25;
+    re[j] = source[j];
+    im[j] = 0;
+  }
+  model.fft(re, im, n);
+  for (size_t k = 0; k < n; k++) {
+    double sum_re = 0, sum_im = 0;
+    for (size_t j = 0; j < n; j++) {
+      sum_re += source[j] * cos(2 * M_PI * k * j / n);
+      sum_im -= source[j] * sin(2 * M_PI * k * j / n);
+    }
+    EXPECT_NEAR(re[k], sum_re, 1e-9);
+    EXPECT_NEAR(im[k], sum_im, 1e-9);
+  }
+}
+
+TEST(Model_spectrum, Test2) {
+  s21::ModelSpectrum model;
+  std::vector<double> x(2000), y(2000);
+  for (size_t j = 0; j < x.size(); j++) {
+    x[j] = j * 0.01;
+    y[j] = 1.5 + 3 * cos(2 * M_PI * 5 * x[j]);
+  }
+  model.calculate(x.data(), y.data(), x.size());
+  EXPECT_EQ(model.magnitude.size(), 1025u);
+  size_t peak = 1;
+  for (size_t k = 1; k < model.magnitude.size(); k++)
+    if (model.magnitude[k] > model.magnitude[peak]) peak = k;
+  EXPECT_NEAR(model.frequency[peak], 5, 0.06);
+  EXPECT_NEAR(model.magnitude[0], 1.5, 0.05);
+  EXPECT_GT(model.magnitude[peak], 2);
+}
+
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -1,29 +1,121 @@
-#include "credit.h"
-
-#include "ui_credit.h"
-
-Credit::Credit(QWidget *parent) : QWidget(parent), ui(new Ui::Credit) {
-  ui->setupUi(this);
-}
-
-Credit::Credit(QWidget *parent, s21::ControllerCredit *c)
-    : QWidget(parent), ui(new Ui::Credit), controller(c) {
-  ui->setupUi(this);
-}
-
-Credit::~Credit() { delete ui; }
-
-void Credit::on_pushButton_calculate_clicked() {
-  ui->label_error->setText(QString::fromStdString(
-      controller->check(ui->lineEdit_sum_val->text().toStdString(),
-                        ui->lineEdit_date_val->text().toStdString(),
-                        ui->lineEdit_procent_val->text().toStdString(),
-                        ui->comboBox_type->currentText().toStdString())));
-  controller->calculate();
-  ui->label_payment_val->setText(
-      QString::fromStdString(controller->get_payment()));
-  ui->label_overpayment_val->setText(
-      QString::fromStdString(controller->get_overpayment()));
-  ui->label_payment_sum_val->setText(
-      QString::fromStdString(controller->get_sum_total()));
-}
+#include "credit.h"
+
+#include <QHeaderView>
+
+#include "ui_credit.h"
+
+Credit::Credit(QWidget *parent)
+    : QWidget(parent), ui(new Ui::Credit), schedule(nullptr) {
+  ui->setupUi(this);
+}
+
+Credit::Credit(QWidget *parent, s21::ControllerCredit *c)
+    : QWidget(parent), ui(new Ui::Credit), controller(c) {
+  ui->setupUi(this);
+  schedule = new Schedule(this, controller);
+  ui->tableView_schedule->setModel(schedule);
+  // Фиксированная высота строк: виду не нужно опрашивать все строки, чтобы
+  // разметить полосу прокрутки
+  ui->tableView_schedule->verticalHeader()->setSectionResizeMode(
+      QHeaderView::Fixed);
+  ui->tableView_schedule->horizontalHeader()->setSectionResizeMode(
+      QHeaderView::Stretch);
+  setup_charts();
+  // Графики и таблица пересчитываются при изменении входных данных
+  connect(ui->lineEdit_sum_val, &QLineEdit::textChanged, this,
+          &Credit::on_pushButton_calculate_clicked);
+  connect(ui->lineEdit_date_val, &QLineEdit::textChanged, this,
+          &Credit::on_pushButton_calculate_clicked);
+  connect(ui->lineEdit_procent_val, &QLineEdit::textChanged, this,
+          &Credit::on_pushButton_calculate_clicked);
+  connect(ui->comboBox_type, &QComboBox::currentIndexChanged, this,
+          &Credit::on_pushButton_calculate_clicked);
+}
+
+Credit::~Credit() { delete ui; }
+
+// Пересчёт только при изменившихся входных данных: повторное нажатие или
+// сигнал без фактического изменения текста не строит график заново
+void Credit::on_pushButton_calculate_clicked() {
+  QStringList current = {
+      ui->lineEdit_sum_val->text(), ui->lineEdit_date_val->text(),
+      ui->lineEdit_procent_val->text(), ui->comboBox_type->currentText()};
+  if (current != inputs) {
+    inputs = current;
+    ui->label_error->setText(QString::fromStdString(controller->check(
+        inputs[0].toStdString(), inputs[1].toStdString(),
+        inputs[2].toStdString(), inputs[3].toStdString())));
+    controller->calculate();
+    ui->label_payment_val->setText(
+        QString::fromStdString(controller->get_payment()));
+    ui->label_overpayment_val->setText(
+        QString::fromStdString(controller->get_overpayment()));
+    ui->label_payment_sum_val->setText(
+        QString::fromStdString(controller->get_sum_total()));
+    schedule->update();
+    plot_schedule();
+  }
+}
+
+// Графики создаются один раз, дальше у них меняются только данные
+void Credit::setup_charts() {
+  balance = ui->widget_balance->addGraph();
+  balance->setBrush(QBrush(QColor(0, 0, 255, 40)));
+  balance->setName("Остаток");
+  ui->widget_balance->legend->setVisible(true);
+  principal_bars = new QCPBars(ui->widget_payments->xAxis,
+                               ui->widget_payments->yAxis);
+  interest_bars = new QCPBars(ui->widget_payments->xAxis,
+                              ui->widget_payments->yAxis);
+  principal_bars->setName("Основной долг");
+  principal_bars->setPen(Qt::NoPen);
+  principal_bars->setBrush(QColor(0, 128, 0));
+  interest_bars->setName("Проценты");
+  interest_bars->setPen(Qt::NoPen);
+  interest_bars->setBrush(QColor(200, 0, 0));
+  interest_bars->moveAbove(principal_bars);
+  ui->widget_payments->legend->setVisible(true);
+}
+
+// Строки графика пишутся прямо в контейнеры QCustomPlot: ключи идут по
+// возрастанию, поэтому add дописывает точки в конец без сортировки. Если
+// месяцев больше, чем пикселей по ширине, соседние месяцы объединяются:
+// остаток берётся на конец группы, столбцы - средний платёж группы
+void Credit::plot_schedule() {
+  int rows = controller->get_schedule_rows();
+  int width = ui->widget_payments->axisRect()->width();
+  int step = width > 0 && rows > width ? (rows + width - 1) / width : 1;
+  QSharedPointer<QCPGraphDataContainer> balance_data = balance->data();
+  QSharedPointer<QCPBarsDataContainer> principal_data =
+      principal_bars->data();
+  QSharedPointer<QCPBarsDataContainer> interest_data = interest_bars->data();
+  balance_data->clear();
+  principal_data->clear();
+  interest_data->clear();
+  double payment = 0, principal = 0, interest = 0, rest = 0;
+  if (rows > 0) {
+    controller->get_schedule_row(1, &payment, &principal, &interest, &rest);
+    balance_data->add(QCPGraphData(0, rest + principal));
+  }
+  for (int begin = 1; begin <= rows; begin += step) {
+    int end = qMin(begin + step - 1, rows);
+    double sum_principal = 0, sum_interest = 0;
+    for (int k = begin; k <= end; k++) {
+      controller->get_schedule_row(k, &payment, &principal, &interest, &rest);
+      sum_principal += principal;
+      sum_interest += interest;
+    }
+    int count = end - begin + 1;
+    double key = (begin + end) / 2.0;
+    balance_data->add(QCPGraphData(end, rest));
+    principal_data->add(QCPBarsData(key, sum_principal / count));
+    interest_data->add(QCPBarsData(key, sum_interest / count));
+  }
+  principal_bars->setWidth(step);
+  interest_bars->setWidth(step);
+  ui->widget_balance->rescaleAxes();
+  ui->widget_payments->rescaleAxes();
+  ui->widget_payments->yAxis->setRangeLower(0);
+  ui->widget_balance->replot(QCustomPlot::rpQueuedReplot);
+  ui->widget_payments->replot(QCustomPlot::rpQueuedReplot);
+}
@@ -5,6 +5,8 @@
 
 #include "../Controller/ControllerCredit.h"
 #include "QWidget"
+#include "qcustomplot.h"
+#include "schedule.h"
 
 namespace Ui {
 class Credit;
@@ -25,6 +27,14 @@ class Credit : public QWidget {
  private:
   Ui::Credit *ui;
   s21::ControllerCredit *controller;
+  Schedule *schedule;
+  QCPGraph *balance = nullptr;
+  QCPBars *principal_bars = nullptr;
+  QCPBars *interest_bars = nullptr;
+  QStringList inputs;
+
+  void setup_charts();
+  void plot_schedule();
 };
 
 #endif  // CPP3_SMARTCALC_SRC_VIEW_CREDIT_H
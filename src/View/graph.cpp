@@ -1,5 +1,7 @@
 #include "graph.h"
 
+#include <QFileDialog>
+
 #include "mainwindow.h"
 #include "ui_graph.h"
 
@@ -15,21 +17,131 @@ Graph::Graph(QWidget *parent, s21::ControllerGraph *c)
 Graph::~Graph() { delete ui; }
 
 void Graph::on_pushButton_graph_clicked() {
-  ui->label_error->setText(
-      controller->check(ui->lineEdit_func_expression->text()));
+  QString expression = ui->lineEdit_func_expression->text();
+  bool implicit = ui->checkBox_implicit->isChecked();
+  bool complex = ui->checkBox_complex->isChecked();
+  if (implicit)
+    ui->label_error->setText(controller->check_implicit(expression));
+  else if (complex)
+    ui->label_error->setText(controller->check_complex(expression));
+  else
+    ui->label_error->setText(controller->check(expression));
 
   ui->label_error->setText(controller->get_axis(
       ui->label_error->text(), ui->lineEdit_min_x_val->text(),
       ui->lineEdit_max_x_val->text(), ui->lineEdit_min_y_val->text(),
       ui->lineEdit_max_y_val->text()));
 
-  controller->calculate(ui->lineEdit_func_expression->text());
-
   ui->widget->xAxis->setRange(controller->get_min_x(), controller->get_max_x());
   ui->widget->yAxis->setRange(controller->get_min_y(), controller->get_max_y());
-  ui->widget->clearGraphs();
-  ui->widget->addGraph();
-  ui->widget->graph(0)->addData(controller->get_x_cords(),
-                                controller->get_y_cords());
+  ui->widget->clearPlottables();
+  overlay = nullptr;
+  controller->set_precise(ui->checkBox_precise->isChecked());
+  if (implicit) {
+    controller->calculate_implicit(expression);
+    QCPCurve *curve = new QCPCurve(ui->widget->xAxis, ui->widget->yAxis);
+    curve->setData(controller->get_implicit_x(), controller->get_implicit_y());
+  } else if (complex) {
+    controller->calculate_domain(expression);
+    plot_domain();
+  } else if (ui->checkBox_spectrum->isChecked()) {
+    controller->calculate(expression);
+    controller->calculate_spectrum();
+    ui->widget->addGraph();
+    ui->widget->graph(0)->addData(controller->get_spectrum_x(),
+                                  controller->get_spectrum_y());
+    ui->widget->rescaleAxes();
+  } else {
+    controller->calculate(expression);
+    ui->widget->addGraph();
+    ui->widget->graph(0)->addData(controller->get_x_cords(),
+                                  controller->get_y_cords());
+  }
+  if (!ui->checkBox_spectrum->isChecked()) plot_data();
   ui->widget->replot();
 }
+
+void Graph::on_pushButton_data_clicked() {
+  QString path = QFileDialog::getOpenFileName(this, "Open data", "",
+                                              "Data (*.csv *.txt *.bin)");
+  if (!path.isEmpty()) {
+    ui->label_error->setText(controller->load_data(path));
+    plot_data();
+    ui->widget->replot();
+  }
+}
+
+// Параметры подбираются по загруженным данным, кривая рисуется поверх них
+void Graph::on_pushButton_fit_clicked() {
+  ui->label_error->setText(
+      controller->fit(ui->lineEdit_func_expression->text(),
+                      ui->lineEdit_fit_params->text()));
+  ui->widget->clearPlottables();
+  overlay = nullptr;
+  plot_data();
+  QCPGraph *fitted = ui->widget->addGraph();
+  fitted->setData(controller->get_fit_x(), controller->get_fit_y());
+  fitted->setPen(QPen(Qt::darkGreen, 2));
+  ui->widget->replot();
+}
+
+// Загруженные данные рисуются точками поверх графика функции: первый
+// столбец - x, второй - y (для одного столбца x - номер строки). Прежние
+// точки убираются, в том числе когда загрузка не удалась
+void Graph::plot_data() {
+  size_t rows = controller->get_data_rows();
+  size_t columns = controller->get_data_columns();
+  if (overlay != nullptr) ui->widget->removeGraph(overlay);
+  overlay = nullptr;
+  if (rows > 0) {
+    const double *keys = controller->get_data_column(0);
+    const double *values = controller->get_data_column(columns > 1 ? 1 : 0);
+    // Контейнер заполняется на месте без промежуточного QVector: точки с
+    // возрастающим ключом дописываются в конец, затем через begin()
+    // получают свои значения и при двух столбцах сортируются по ключу
+    QSharedPointer<QCPGraphDataContainer> container(new QCPGraphDataContainer);
+    for (size_t r = 0; r < rows; r++) container->add(QCPGraphData(r, 0));
+    QCPGraphDataContainer::iterator point = container->begin();
+    for (size_t r = 0; r < rows; r++, ++point) {
+      point->key = columns > 1 ? keys[r] : r;
+      point->value = values[r];
+    }
+    if (columns > 1) container->sort();
+    overlay = ui->widget->addGraph();
+    overlay->setData(container);
+    overlay->setLineStyle(QCPGraph::lsNone);
+    overlay->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssDot));
+    overlay->setPen(QPen(Qt::red));
+  }
+}
+
+// Раскраска области: оттенок - аргумент f(x), яркость растёт от тёмной к
+// светлой внутри каждого удвоения модуля. Значение ячейки - номер
+// оттенка плюс доля яркости, поэтому шкала собрана из DOMAIN_HUES
+// отрезков одного оттенка; точки, где f не определена, прозрачны
+void Graph::plot_domain() {
+  QVector<double> values = controller->get_domain();
+  if (values.size() == DOMAIN_GRID * DOMAIN_GRID) {
+    QCPColorMap *map = new QCPColorMap(ui->widget->xAxis, ui->widget->yAxis);
+    map->data()->setSize(DOMAIN_GRID, DOMAIN_GRID);
+    map->data()->setRange(
+        QCPRange(controller->get_min_x(), controller->get_max_x()),
+        QCPRange(controller->get_min_y(), controller->get_max_y()));
+    for (int iy = 0; iy < DOMAIN_GRID; iy++)
+      for (int ix = 0; ix < DOMAIN_GRID; ix++)
+        map->data()->setCell(ix, iy, values[iy * DOMAIN_GRID + ix]);
+    QCPColorGradient gradient;
+    gradient.clearColorStops();
+    for (int k = 0; k < DOMAIN_HUES; k++) {
+      double hue = (double)k / DOMAIN_HUES;
+      gradient.setColorStopAt(hue, QColor::fromHsvF(hue, 1, 0.5));
+      gradient.setColorStopAt(hue + 0.999 / DOMAIN_HUES,
+                              QColor::fromHsvF(hue, 0.8, 1));
+    }
+    gradient.setLevelCount(DOMAIN_HUES * 16);
+    gradient.setNanHandling(QCPColorGradient::nhTransparent);
+    map->setGradient(gradient);
+    map->setInterpolate(false);
+    map->setDataRange(QCPRange(0, DOMAIN_HUES));
+  }
+}
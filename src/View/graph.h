@@ -22,10 +22,17 @@ class Graph : public QWidget {
 
  private slots:
   void on_pushButton_graph_clicked();
+  void on_pushButton_data_clicked();
+  void on_pushButton_fit_clicked();
 
  private:
   Ui::Graph *ui;
   s21::ControllerGraph *controller;
+  // Точки загруженных данных; clearPlottables удаляет и их
+  QCPGraph *overlay = nullptr;
+
+  void plot_data();
+  void plot_domain();
 };
 
 #endif  // GRAPH_H
@@ -1,5 +1,8 @@
 #include "mainwindow.h"
 
+#include <QFileDialog>
+#include <QInputDialog>
+
 #include "ui_mainwindow.h"
 
 MainWindow::MainWindow(QWidget *parent, s21::ControllerCalculator *c_ca,
@@ -190,6 +193,9 @@ void MainWindow::on_pushButton_delete_all_clicked() {
 }
 
 void MainWindow::on_pushButton_calculate_clicked() {
+  controller_calc->set_complex(ui->checkBox_complex->isChecked());
+  controller_calc->set_digits(ui->spinBox_digits->value());
+  controller_calc->set_parallel(ui->checkBox_parallel->isChecked());
   ui->label_result->setText(
       controller_calc->calculate(ui->lineEdit_expression->text()));
 }
@@ -202,3 +208,13 @@ void MainWindow::on_pushButton_x_set_clicked() {
 void MainWindow::on_pushButton_graph_clicked() { graph->show(); }
 
 void MainWindow::on_pushButton_credit_clicked() { credit->show(); }
+
+// Библиотека и имена её функций через запятую, например "phi, sinc"
+void MainWindow::on_pushButton_plugin_clicked() {
+  QString path = QFileDialog::getOpenFileName(this, "Load functions", "",
+                                              "Libraries (*.so)");
+  if (!path.isEmpty()) {
+    QString names = QInputDialog::getText(this, "Load functions", "Names:");
+    ui->label_result->setText(controller_calc->load_plugin(path, names));
+  }
+}
@@ -99,6 +99,8 @@ class MainWindow : public QMainWindow {
 
   void on_pushButton_credit_clicked();
 
+  void on_pushButton_plugin_clicked();
+
  private:
   Ui::MainWindow *ui;
 
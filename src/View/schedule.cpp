@@ -0,0 +1,48 @@
+#include "schedule.h"
+
+Schedule::Schedule(QObject *parent, s21::ControllerCredit *c)
+    : QAbstractTableModel(parent), controller(c) {}
+
+int Schedule::rowCount(const QModelIndex &parent) const {
+  return parent.isValid() ? 0 : rows;
+}
+
+int Schedule::columnCount(const QModelIndex &parent) const {
+  return parent.isValid() ? 0 : 4;
+}
+
+QVariant Schedule::data(const QModelIndex &index, int role) const {
+  QVariant res;
+  double value[4] = {0, 0, 0, 0};
+  if (role == Qt::DisplayRole && index.isValid() &&
+      controller->get_schedule_row(index.row() + 1, &value[0], &value[1],
+                                   &value[2], &value[3])) {
+    res = QString::number(value[index.column()], 'f', 2);
+  }
+  if (role == Qt::TextAlignmentRole) {
+    res = int(Qt::AlignRight | Qt::AlignVCenter);
+  }
+  return res;
+}
+
+QVariant Schedule::headerData(int section, Qt::Orientation orientation,
+                              int role) const {
+  QVariant res;
+  if (role == Qt::DisplayRole) {
+    if (orientation == Qt::Horizontal) {
+      const char *names[] = {"Платеж", "Основной долг", "Проценты",
+                             "Остаток"};
+      res = QString::fromUtf8(names[section]);
+    } else {
+      res = section + 1;
+    }
+  }
+  return res;
+}
+
+// Вызывается после расчёта: меняется только число строк
+void Schedule::update() {
+  beginResetModel();
+  rows = controller->get_schedule_rows();
+  endResetModel();
+}
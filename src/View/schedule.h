@@ -0,0 +1,31 @@
+#ifndef CPP3_SMARTCALC_SRC_VIEW_SCHEDULE_H
+#define CPP3_SMARTCALC_SRC_VIEW_SCHEDULE_H
+
+#include <QAbstractTableModel>
+
+#include "../Controller/ControllerCredit.h"
+
+// График платежей для QTableView: строки не хранятся, каждая ячейка
+// считается и форматируется, только когда вид её запрашивает
+class Schedule : public QAbstractTableModel {
+  Q_OBJECT
+
+ public:
+  explicit Schedule(QObject *parent = nullptr,
+                    s21::ControllerCredit *c = nullptr);
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+  int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex &index,
+                int role = Qt::DisplayRole) const override;
+  QVariant headerData(int section, Qt::Orientation orientation,
+                      int role = Qt::DisplayRole) const override;
+
+  void update();
+
+ private:
+  s21::ControllerCredit *controller;
+  int rows = 0;
+};
+
+#endif  // CPP3_SMARTCALC_SRC_VIEW_SCHEDULE_H